@@ -0,0 +1,491 @@
+#include "compact_index.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <queue>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace amine
+{
+  namespace
+  {
+    void writeVarint(std::vector< unsigned char >& out, uint64_t value)
+    {
+      while (value >= 0x80)
+      {
+        out.push_back(static_cast< unsigned char >(value | 0x80));
+        value >>= 7;
+      }
+      out.push_back(static_cast< unsigned char >(value));
+    }
+
+    uint64_t readVarint(const unsigned char*& current, const unsigned char* end)
+    {
+      uint64_t value = 0;
+      unsigned shift = 0;
+      while (current != end)
+      {
+        unsigned char byte = *current++;
+        if (shift < 64)
+          value |= static_cast< uint64_t >(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+          break;
+        shift += 7;
+      }
+      return value;
+    }
+
+    // Binary layout: header, word offsets, posting offsets (8-byte aligned), vocabulary, postings.
+    // Arrays are stored in host byte order so a mapped file can be read in place.
+    const char BINARY_MAGIC[4] = { 'A', 'X', 'R', 'I' };
+    const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    struct BinaryHeader
+    {
+      char magic[4];
+      uint32_t byteOrder;
+      uint64_t words;
+      uint64_t vocabularyBytes;
+      uint64_t postingBytes;
+    };
+
+    size_t alignTo8(size_t offset)
+    {
+      return (offset + 7) & ~static_cast< size_t >(7);
+    }
+
+    size_t postingOffsetsAt(size_t words)
+    {
+      return alignTo8(sizeof(BinaryHeader) + (words + 1) * sizeof(uint32_t));
+    }
+  }
+
+  struct CompactIndex::MappedFile
+  {
+    void* address;
+    size_t length;
+    View view;
+
+    ~MappedFile()
+    {
+      munmap(address, length);
+    }
+  };
+
+  // Deltas are taken modulo 2^64, so positions added out of order still decode exactly.
+  void encodePosition(std::vector< unsigned char >& out, const Position& last, const Position& pos)
+  {
+    size_t lineDelta = pos.line - last.line;
+    writeVarint(out, lineDelta);
+    writeVarint(out, lineDelta == 0 ? pos.column - last.column : pos.column);
+  }
+
+  PositionReader::PositionReader(const unsigned char* begin, const unsigned char* end):
+    current_(begin),
+    end_(end),
+    last_{ 0, 0 }
+  {}
+
+  bool PositionReader::next(Position& pos)
+  {
+    if (current_ == end_)
+      return false;
+    size_t lineDelta = readVarint(current_, end_);
+    size_t column = readVarint(current_, end_);
+    last_.line += lineDelta;
+    last_.column = lineDelta == 0 ? last_.column + column : column;
+    pos = last_;
+    return true;
+  }
+
+  void CompactIndex::Builder::add(const std::string& word, size_t line, size_t column)
+  {
+    auto inserted = ids_.emplace(word, words_.size());
+    if (inserted.second)
+    {
+      words_.push_back(word);
+      postings_.push_back(Postings{ {}, Position{ 0, 0 }, true });
+    }
+    Postings& postings = postings_[inserted.first->second];
+    Position pos{ line, column };
+    if (!postings.bytes.empty() && !positionLess()(postings.last, pos))
+      postings.sorted = false;
+    encodePosition(postings.bytes, postings.last, pos);
+    postings.last = pos;
+  }
+
+  CompactIndex CompactIndex::Builder::build()
+  {
+    for (Postings& postings: postings_)
+    {
+      if (postings.sorted)
+        continue;
+      std::vector< Position > decoded;
+      PositionReader reader(postings.bytes.data(), postings.bytes.data() + postings.bytes.size());
+      Position pos{ 0, 0 };
+      while (reader.next(pos))
+        decoded.push_back(pos);
+      std::sort(decoded.begin(), decoded.end(), positionLess());
+      auto same = [](const Position& a, const Position& b) { return a.line == b.line && a.column == b.column; };
+      decoded.erase(std::unique(decoded.begin(), decoded.end(), same), decoded.end());
+      postings.bytes.clear();
+      Position last{ 0, 0 };
+      for (const Position& next: decoded)
+      {
+        encodePosition(postings.bytes, last, next);
+        last = next;
+      }
+    }
+
+    std::vector< size_t > order(words_.size());
+    for (size_t i = 0; i < order.size(); ++i)
+      order[i] = i;
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return words_[a] < words_[b]; });
+
+    CompactIndex result;
+    size_t vocabularyBytes = 0;
+    size_t postingBytes = 0;
+    for (size_t i = 0; i < words_.size(); ++i)
+    {
+      vocabularyBytes += words_[i].size();
+      postingBytes += postings_[i].bytes.size();
+    }
+    result.vocabulary_.reserve(vocabularyBytes);
+    result.postings_.reserve(postingBytes);
+    result.wordOffsets_.reserve(words_.size() + 1);
+    result.postingOffsets_.reserve(words_.size() + 1);
+
+    for (size_t id: order)
+    {
+      const std::vector< unsigned char >& bytes = postings_[id].bytes;
+      result.appendWord(words_[id].data(), words_[id].size(), bytes.data(), bytes.data() + bytes.size());
+    }
+    ids_.clear();
+    words_.clear();
+    postings_.clear();
+    return result;
+  }
+
+  CompactIndex::CompactIndex():
+    vocabulary_(),
+    wordOffsets_(1, 0),
+    postings_(),
+    postingOffsets_(1, 0),
+    file_()
+  {}
+
+  CompactIndex::CompactIndex(const Index& index):
+    CompactIndex()
+  {
+    std::vector< unsigned char > bytes;
+    for (const auto& entry: index)
+    {
+      bytes.clear();
+      Position last{ 0, 0 };
+      for (const Position& pos: entry.second)
+      {
+        encodePosition(bytes, last, pos);
+        last = pos;
+      }
+      appendWord(entry.first.data(), entry.first.size(), bytes.data(), bytes.data() + bytes.size());
+    }
+  }
+
+  void CompactIndex::appendWord(const char* word, size_t length, const unsigned char* begin,
+                                const unsigned char* end)
+  {
+    vocabulary_.append(word, length);
+    wordOffsets_.push_back(static_cast< uint32_t >(vocabulary_.size()));
+    postings_.insert(postings_.end(), begin, end);
+    postingOffsets_.push_back(postings_.size());
+  }
+
+  CompactIndex::View CompactIndex::view() const
+  {
+    if (file_)
+      return file_->view;
+    return View{ vocabulary_.data(), wordOffsets_.data(), postings_.data(), postingOffsets_.data(),
+                 wordOffsets_.size() - 1 };
+  }
+
+  bool CompactIndex::empty() const
+  {
+    return size() == 0;
+  }
+
+  size_t CompactIndex::size() const
+  {
+    return view().words;
+  }
+
+  std::string CompactIndex::word(size_t id) const
+  {
+    return std::string(wordData(id), wordLength(id));
+  }
+
+  const char* CompactIndex::wordData(size_t id) const
+  {
+    View v = view();
+    return v.vocabulary + v.wordOffsets[id];
+  }
+
+  size_t CompactIndex::wordLength(size_t id) const
+  {
+    View v = view();
+    return v.wordOffsets[id + 1] - v.wordOffsets[id];
+  }
+
+  const unsigned char* CompactIndex::postingBegin(size_t id) const
+  {
+    View v = view();
+    return v.postings + v.postingOffsets[id];
+  }
+
+  const unsigned char* CompactIndex::postingEnd(size_t id) const
+  {
+    View v = view();
+    return v.postings + v.postingOffsets[id + 1];
+  }
+
+  PositionReader CompactIndex::positions(size_t id) const
+  {
+    return PositionReader(postingBegin(id), postingEnd(id));
+  }
+
+  int CompactIndex::compareWord(size_t id, const std::string& word) const
+  {
+    int cmp = word.compare(0, std::string::npos, wordData(id), wordLength(id));
+    return (cmp < 0) - (cmp > 0);
+  }
+
+  size_t CompactIndex::find(const std::string& word) const
+  {
+    size_t low = 0;
+    size_t high = size();
+    while (low < high)
+    {
+      size_t mid = low + (high - low) / 2;
+      int cmp = compareWord(mid, word);
+      if (cmp == 0)
+        return mid;
+      if (cmp < 0)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+    return npos;
+  }
+
+  bool CompactIndex::contains(const std::string& word) const
+  {
+    return find(word) != npos;
+  }
+
+  bool CompactIndex::saveBinary(const std::string& fileName) const
+  {
+    View v = view();
+    BinaryHeader header{ {}, BYTE_ORDER_MARK, v.words, v.wordOffsets[v.words], v.postingOffsets[v.words] };
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    size_t wordOffsetsEnd = sizeof(BinaryHeader) + (v.words + 1) * sizeof(uint32_t);
+    const char padding[8] = {};
+
+    std::string tempName = fileName + ".tmp";
+    std::ofstream out(tempName, std::ios::binary);
+    if (!out.is_open())
+      return false;
+    out.write(reinterpret_cast< const char* >(&header), sizeof(header));
+    out.write(reinterpret_cast< const char* >(v.wordOffsets), (v.words + 1) * sizeof(uint32_t));
+    out.write(padding, postingOffsetsAt(v.words) - wordOffsetsEnd);
+    out.write(reinterpret_cast< const char* >(v.postingOffsets), (v.words + 1) * sizeof(uint64_t));
+    out.write(v.vocabulary, header.vocabularyBytes);
+    out.write(reinterpret_cast< const char* >(v.postings), header.postingBytes);
+    out.close();
+    if (!out || std::rename(tempName.c_str(), fileName.c_str()) != 0)
+    {
+      std::remove(tempName.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  bool CompactIndex::hasBinaryHeader(const std::string& fileName)
+  {
+    std::ifstream in(fileName, std::ios::binary);
+    char magic[sizeof(BINARY_MAGIC)] = {};
+    in.read(magic, sizeof(magic));
+    return in && std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) == 0;
+  }
+
+  bool CompactIndex::mapBinary(const std::string& fileName, CompactIndex& result)
+  {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast< size_t >(info.st_size) < sizeof(BinaryHeader))
+    {
+      close(fd);
+      return false;
+    }
+    size_t length = info.st_size;
+    void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED)
+      return false;
+
+    auto file = std::make_shared< MappedFile >();
+    file->address = address;
+    file->length = length;
+    const char* base = static_cast< const char* >(address);
+    BinaryHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0 || header.byteOrder != BYTE_ORDER_MARK)
+      return false;
+    if (header.words >= length / sizeof(uint64_t) || header.vocabularyBytes > length || header.postingBytes > length)
+      return false;
+
+    size_t postingOffsetsStart = postingOffsetsAt(header.words);
+    size_t vocabularyStart = postingOffsetsStart + (header.words + 1) * sizeof(uint64_t);
+    size_t postingsStart = vocabularyStart + header.vocabularyBytes;
+    if (postingsStart + header.postingBytes != length)
+      return false;
+
+    View& v = file->view;
+    v.wordOffsets = reinterpret_cast< const uint32_t* >(base + sizeof(BinaryHeader));
+    v.postingOffsets = reinterpret_cast< const uint64_t* >(base + postingOffsetsStart);
+    v.vocabulary = base + vocabularyStart;
+    v.postings = reinterpret_cast< const unsigned char* >(base + postingsStart);
+    v.words = header.words;
+    if (v.wordOffsets[0] != 0 || v.wordOffsets[v.words] != header.vocabularyBytes)
+      return false;
+    if (v.postingOffsets[0] != 0 || v.postingOffsets[v.words] != header.postingBytes)
+      return false;
+    // With both ends fixed, non-decreasing offsets keep every word and posting list inside the file.
+    for (size_t id = 0; id < v.words; ++id)
+    {
+      if (v.wordOffsets[id] > v.wordOffsets[id + 1] || v.postingOffsets[id] > v.postingOffsets[id + 1])
+        return false;
+    }
+
+    result = CompactIndex();
+    result.file_ = file;
+    return true;
+  }
+
+  Index CompactIndex::toIndex() const
+  {
+    Index result;
+    for (size_t id = 0; id < size(); ++id)
+    {
+      auto& positionSet = result.emplace_hint(result.end(), word(id), std::set< Position, positionLess >())->second;
+      PositionReader reader = positions(id);
+      Position pos{ 0, 0 };
+      while (reader.next(pos))
+        positionSet.emplace_hint(positionSet.end(), pos);
+    }
+    return result;
+  }
+
+  CompactIndex CompactIndex::withWordReplaced(const std::string& oldWord, const std::string& newWord) const
+  {
+    size_t oldId = find(oldWord);
+    CompactIndex result;
+    bool placed = false;
+    for (size_t id = 0; id < size(); ++id)
+    {
+      if (id == oldId)
+        continue;
+      int cmp = placed ? -1 : compareWord(id, newWord);
+      if (cmp >= 0)
+      {
+        result.appendWord(newWord.data(), newWord.size(), postingBegin(oldId), postingEnd(oldId));
+        placed = true;
+        if (cmp == 0)
+          continue;
+      }
+      result.appendWord(wordData(id), wordLength(id), postingBegin(id), postingEnd(id));
+    }
+    if (!placed)
+      result.appendWord(newWord.data(), newWord.size(), postingBegin(oldId), postingEnd(oldId));
+    return result;
+  }
+
+  CompactIndex CompactIndex::withWordsSwapped(const std::string& word1, const std::string& word2) const
+  {
+    size_t id1 = find(word1);
+    size_t id2 = find(word2);
+    CompactIndex result;
+    for (size_t id = 0; id < size(); ++id)
+    {
+      size_t source = id == id1 ? id2 : (id == id2 ? id1 : id);
+      result.appendWord(wordData(id), wordLength(id), postingBegin(source), postingEnd(source));
+    }
+    return result;
+  }
+
+  int CompactIndex::compareWords(const CompactIndex& left, size_t leftId, const CompactIndex& right, size_t rightId)
+  {
+    size_t leftLength = left.wordLength(leftId);
+    size_t rightLength = right.wordLength(rightId);
+    int cmp = std::char_traits< char >::compare(left.wordData(leftId), right.wordData(rightId),
+                                                std::min(leftLength, rightLength));
+    if (cmp == 0)
+      cmp = (leftLength > rightLength) - (leftLength < rightLength);
+    return cmp;
+  }
+
+  CompactIndex CompactIndex::merge(const std::vector< const CompactIndex* >& parts,
+                                   const std::vector< size_t >& lineOffsets)
+  {
+    struct Cursor
+    {
+      size_t part;
+      size_t id;
+    };
+    auto compare = [&parts](const Cursor& a, const Cursor& b) {
+      return compareWords(*parts[a.part], a.id, *parts[b.part], b.id);
+    };
+    auto later = [&compare](const Cursor& a, const Cursor& b) {
+      int cmp = compare(a, b);
+      return cmp > 0 || (cmp == 0 && a.part > b.part);
+    };
+    std::priority_queue< Cursor, std::vector< Cursor >, decltype(later) > heap(later);
+    for (size_t part = 0; part < parts.size(); ++part)
+    {
+      if (!parts[part]->empty())
+        heap.push(Cursor{ part, 0 });
+    }
+
+    CompactIndex result;
+    std::vector< unsigned char > bytes;
+    while (!heap.empty())
+    {
+      Cursor first = heap.top();
+      bytes.clear();
+      Position last{ 0, 0 };
+      while (!heap.empty() && compare(heap.top(), first) == 0)
+      {
+        Cursor cursor = heap.top();
+        heap.pop();
+        PositionReader reader = parts[cursor.part]->positions(cursor.id);
+        Position pos{ 0, 0 };
+        while (reader.next(pos))
+        {
+          pos.line += lineOffsets[cursor.part];
+          encodePosition(bytes, last, pos);
+          last = pos;
+        }
+        if (cursor.id + 1 < parts[cursor.part]->size())
+          heap.push(Cursor{ cursor.part, cursor.id + 1 });
+      }
+      const CompactIndex& source = *parts[first.part];
+      result.appendWord(source.wordData(first.id), source.wordLength(first.id), bytes.data(),
+                        bytes.data() + bytes.size());
+    }
+    return result;
+  }
+}
@@ -0,0 +1,103 @@
+#ifndef COMPACT_INDEX_HPP
+#define COMPACT_INDEX_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "position.hpp"
+
+namespace amine
+{
+  class PositionReader
+  {
+  public:
+    PositionReader(const unsigned char* begin, const unsigned char* end);
+    bool next(Position& pos);
+
+  private:
+    const unsigned char* current_;
+    const unsigned char* end_;
+    Position last_;
+  };
+
+  class CompactIndex
+  {
+  public:
+    class Builder
+    {
+    public:
+      void add(const std::string& word, size_t line, size_t column);
+      CompactIndex build();
+
+    private:
+      struct Postings
+      {
+        std::vector< unsigned char > bytes;
+        Position last;
+        bool sorted;
+      };
+      std::unordered_map< std::string, size_t > ids_;
+      std::vector< std::string > words_;
+      std::vector< Postings > postings_;
+    };
+
+    CompactIndex();
+    explicit CompactIndex(const Index& index);
+
+    bool empty() const;
+    size_t size() const;
+    std::string word(size_t id) const;
+    const char* wordData(size_t id) const;
+    size_t wordLength(size_t id) const;
+    PositionReader positions(size_t id) const;
+    size_t find(const std::string& word) const;
+    bool contains(const std::string& word) const;
+
+    bool saveBinary(const std::string& fileName) const;
+    static bool hasBinaryHeader(const std::string& fileName);
+    static bool mapBinary(const std::string& fileName, CompactIndex& result);
+
+    Index toIndex() const;
+    CompactIndex withWordReplaced(const std::string& oldWord, const std::string& newWord) const;
+    CompactIndex withWordsSwapped(const std::string& word1, const std::string& word2) const;
+
+    // Words must be appended in ascending order, each with its encoded, sorted positions.
+    void appendWord(const char* word, size_t length, const unsigned char* begin, const unsigned char* end);
+    static int compareWords(const CompactIndex& left, size_t leftId, const CompactIndex& right, size_t rightId);
+
+    // K-way merge by word. Every part's lines are shifted by its offset, and the shifted
+    // lines of a part must all lie after those of the parts before it.
+    static CompactIndex merge(const std::vector< const CompactIndex* >& parts,
+                              const std::vector< size_t >& lineOffsets);
+
+    static const size_t npos = static_cast< size_t >(-1);
+
+    struct View
+    {
+      const char* vocabulary;
+      const uint32_t* wordOffsets;
+      const unsigned char* postings;
+      const uint64_t* postingOffsets;
+      size_t words;
+    };
+    struct MappedFile;
+
+  private:
+    std::string vocabulary_;
+    std::vector< uint32_t > wordOffsets_;
+    std::vector< unsigned char > postings_;
+    std::vector< uint64_t > postingOffsets_;
+    std::shared_ptr< const MappedFile > file_;
+
+    View view() const;
+    const unsigned char* postingBegin(size_t id) const;
+    const unsigned char* postingEnd(size_t id) const;
+    int compareWord(size_t id, const std::string& word) const;
+  };
+
+  void encodePosition(std::vector< unsigned char >& out, const Position& last, const Position& pos);
+}
+
+#endif
@@ -41,6 +41,8 @@ namespace
 
     if (command == "buildIndex" && count == 3)
       xref.buildIndex(tokens[1], tokens[2]);
+    else if (command == "buildIndexFiles" && count == 3)
+      xref.buildIndexFiles(tokens[1], tokens[2]);
     else if (command == "deleteIndex" && count == 2)
       xref.deleteIndex(tokens[1]);
     else if (command == "containsWord" && count == 3)
@@ -68,6 +70,8 @@ namespace
       xref.reverseText(tokens[1], tokens[2]);
     else if (command == "saveIndex" && count == 3)
       xref.saveIndex(tokens[1], tokens[2]);
+    else if (command == "saveIndexBinary" && count == 3)
+      xref.saveIndexBinary(tokens[1], tokens[2]);
     else if (command == "loadIndex" && count == 3)
       xref.loadIndex(tokens[1], tokens[2]);
     else if (command == "reconstructText" && count == 3)
@@ -0,0 +1,395 @@
+#include "piece_text.hpp"
+#include <algorithm>
+#include <queue>
+
+namespace amine
+{
+  namespace
+  {
+    // Stands for an open bound: above any real line, yet far enough from overflow to add offsets to.
+    const long long LINE_LIMIT = 1LL << 62;
+    const size_t ANY_COLUMN = static_cast< size_t >(-1);
+
+    long long floorDiv(long long a, long long b)
+    {
+      long long quotient = a / b;
+      return (a % b != 0 && (a < 0) != (b < 0)) ? quotient - 1 : quotient;
+    }
+
+    long long ceilDiv(long long a, long long b)
+    {
+      long long quotient = a / b;
+      return (a % b != 0 && (a < 0) == (b < 0)) ? quotient + 1 : quotient;
+    }
+
+    long long toLine(size_t line)
+    {
+      return line < static_cast< size_t >(LINE_LIMIT) ? static_cast< long long >(line) : LINE_LIMIT;
+    }
+
+    bool samePosition(const Position& a, const Position& b)
+    {
+      return a.line == b.line && a.column == b.column;
+    }
+  }
+
+  struct PieceText::Source
+  {
+    CompactIndex index;
+    // Occupied columns of every occupied line, collected on first use.
+    mutable bool summarised;
+    mutable std::vector< long long > lines;
+    mutable std::vector< size_t > columnStarts;
+    mutable std::vector< size_t > columns;
+
+    explicit Source(CompactIndex&& source):
+      index(std::move(source)),
+      summarised(false),
+      lines(),
+      columnStarts(),
+      columns()
+    {}
+
+    void summarise() const
+    {
+      if (summarised)
+        return;
+      std::vector< Position > occupied;
+      for (size_t id = 0; id < index.size(); ++id)
+      {
+        PositionReader reader = index.positions(id);
+        Position pos{ 0, 0 };
+        while (reader.next(pos))
+          occupied.push_back(pos);
+      }
+      std::sort(occupied.begin(), occupied.end(), positionLess());
+      occupied.erase(std::unique(occupied.begin(), occupied.end(), samePosition), occupied.end());
+      for (const Position& pos: occupied)
+      {
+        if (lines.empty() || lines.back() != toLine(pos.line))
+        {
+          lines.push_back(toLine(pos.line));
+          columnStarts.push_back(columns.size());
+        }
+        columns.push_back(pos.column);
+      }
+      columnStarts.push_back(columns.size());
+      summarised = true;
+    }
+
+    bool hasColumn(size_t lineIdx, const Columns& range) const
+    {
+      auto begin = columns.begin() + columnStarts[lineIdx];
+      auto end = columns.begin() + columnStarts[lineIdx + 1];
+      auto found = std::lower_bound(begin, end, range.first);
+      return found != end && *found <= range.last;
+    }
+  };
+
+  PieceText::PieceText():
+    pieces_()
+  {}
+
+  PieceText::PieceText(CompactIndex index):
+    pieces_(1, Piece{ std::make_shared< const Source >(std::move(index)), wholeBand(), 1, 0 })
+  {}
+
+  PieceText::Band PieceText::wholeBand()
+  {
+    return Band{ 0, LINE_LIMIT, { 0, ANY_COLUMN }, { 0, ANY_COLUMN } };
+  }
+
+  bool PieceText::inBand(const Band& band, long long line, size_t column)
+  {
+    if (line < band.firstLine || line > band.lastLine)
+      return false;
+    if (line == band.firstLine && (column < band.onFirst.first || column > band.onFirst.last))
+      return false;
+    return line != band.lastLine || (column >= band.onLast.first && column <= band.onLast.last);
+  }
+
+  PieceText::Band PieceText::intersect(const Band& a, const Band& b)
+  {
+    Band result{ std::max(a.firstLine, b.firstLine), std::min(a.lastLine, b.lastLine), { 0, ANY_COLUMN },
+                 { 0, ANY_COLUMN } };
+    auto narrow = [](Columns& columns, const Band& band, long long line) {
+      if (band.firstLine == line)
+        columns = Columns{ std::max(columns.first, band.onFirst.first), std::min(columns.last, band.onFirst.last) };
+      if (band.lastLine == line)
+        columns = Columns{ std::max(columns.first, band.onLast.first), std::min(columns.last, band.onLast.last) };
+    };
+    for (const Band* band: { &a, &b })
+    {
+      narrow(result.onFirst, *band, result.firstLine);
+      narrow(result.onLast, *band, result.lastLine);
+    }
+    return result;
+  }
+
+  // The source band whose lines land inside band once moved by scale * line + offset.
+  // A negative scale reverses the lines, so the boundary lines swap ends.
+  PieceText::Band PieceText::pullBack(const Band& band, long long scale, long long offset)
+  {
+    long long lowTarget = scale > 0 ? band.firstLine : band.lastLine;
+    long long highTarget = scale > 0 ? band.lastLine : band.firstLine;
+    Band result = wholeBand();
+    result.firstLine = ceilDiv(lowTarget - offset, scale);
+    result.lastLine = floorDiv(highTarget - offset, scale);
+    if (scale * result.firstLine + offset == lowTarget)
+      result.onFirst = scale > 0 ? band.onFirst : band.onLast;
+    if (scale * result.lastLine + offset == highTarget)
+      result.onLast = scale > 0 ? band.onLast : band.onFirst;
+    if (result.firstLine < 0)
+    {
+      result.firstLine = 0;
+      result.onFirst = Columns{ 0, ANY_COLUMN };
+    }
+    return result;
+  }
+
+  bool PieceText::lineInBand(const Source& source, size_t lineIdx, const Band& band)
+  {
+    long long line = source.lines[lineIdx];
+    if (line == band.firstLine && !source.hasColumn(lineIdx, band.onFirst))
+      return false;
+    return line != band.lastLine || source.hasColumn(lineIdx, band.onLast);
+  }
+
+  // The piece's last line in text order, if it holds any position at all.
+  bool PieceText::extremeLine(const Piece& piece, long long& line)
+  {
+    const Source& source = *piece.source;
+    source.summarise();
+    size_t begin = std::lower_bound(source.lines.begin(), source.lines.end(), piece.band.firstLine) -
+                   source.lines.begin();
+    size_t end = std::upper_bound(source.lines.begin() + begin, source.lines.end(), piece.band.lastLine) -
+                 source.lines.begin();
+    for (size_t i = 0; i < end - begin; ++i)
+    {
+      size_t lineIdx = piece.scale > 0 ? end - 1 - i : begin + i;
+      if (lineInBand(source, lineIdx, piece.band))
+      {
+        line = piece.scale * source.lines[lineIdx] + piece.offset;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void PieceText::collect(const Piece& piece, size_t id, std::vector< Position >& out)
+  {
+    PositionReader reader = piece.source->index.positions(id);
+    Position pos{ 0, 0 };
+    while (reader.next(pos))
+    {
+      long long line = toLine(pos.line);
+      if (inBand(piece.band, line, pos.column))
+        out.push_back(Position{ static_cast< size_t >(piece.scale * line + piece.offset), pos.column });
+    }
+  }
+
+  bool PieceText::isWhole() const
+  {
+    if (pieces_.size() != 1)
+      return false;
+    const Piece& piece = pieces_.front();
+    const Band& band = piece.band;
+    return piece.scale == 1 && piece.offset == 0 && band.firstLine == 0 && band.lastLine == LINE_LIMIT &&
+           band.onFirst.first == 0 && band.onFirst.last == ANY_COLUMN && band.onLast.first == 0 &&
+           band.onLast.last == ANY_COLUMN;
+  }
+
+  bool PieceText::empty() const
+  {
+    long long line = 0;
+    for (const Piece& piece: pieces_)
+    {
+      if (extremeLine(piece, line))
+        return false;
+    }
+    return true;
+  }
+
+  size_t PieceText::maxLine() const
+  {
+    long long result = 0;
+    long long line = 0;
+    for (const Piece& piece: pieces_)
+    {
+      if (extremeLine(piece, line))
+        result = std::max(result, line);
+    }
+    return static_cast< size_t >(result);
+  }
+
+  size_t PieceText::lineCount() const
+  {
+    std::vector< long long > occupied;
+    for (const Piece& piece: pieces_)
+    {
+      const Source& source = *piece.source;
+      source.summarise();
+      size_t begin = std::lower_bound(source.lines.begin(), source.lines.end(), piece.band.firstLine) -
+                     source.lines.begin();
+      for (size_t i = begin; i < source.lines.size() && source.lines[i] <= piece.band.lastLine; ++i)
+      {
+        if (lineInBand(source, i, piece.band))
+          occupied.push_back(piece.scale * source.lines[i] + piece.offset);
+      }
+    }
+    std::sort(occupied.begin(), occupied.end());
+    return std::unique(occupied.begin(), occupied.end()) - occupied.begin();
+  }
+
+  bool PieceText::hasPosition(const Position& pos) const
+  {
+    long long line = toLine(pos.line);
+    for (const Piece& piece: pieces_)
+    {
+      long long shifted = line - piece.offset;
+      long long sourceLine = shifted / piece.scale;
+      if (shifted % piece.scale != 0 || sourceLine < 0 || !inBand(piece.band, sourceLine, pos.column))
+        continue;
+      const Source& source = *piece.source;
+      source.summarise();
+      auto found = std::lower_bound(source.lines.begin(), source.lines.end(), sourceLine);
+      if (found != source.lines.end() && *found == sourceLine &&
+          source.hasColumn(found - source.lines.begin(), Columns{ pos.column, pos.column }))
+        return true;
+    }
+    return false;
+  }
+
+  bool PieceText::contains(const std::string& word) const
+  {
+    for (const Piece& piece: pieces_)
+    {
+      size_t id = piece.source->index.find(word);
+      if (id == CompactIndex::npos)
+        continue;
+      PositionReader reader = piece.source->index.positions(id);
+      Position pos{ 0, 0 };
+      while (reader.next(pos))
+      {
+        if (inBand(piece.band, toLine(pos.line), pos.column))
+          return true;
+      }
+    }
+    return false;
+  }
+
+  std::vector< Position > PieceText::positions(const std::string& word) const
+  {
+    std::vector< Position > result;
+    for (const Piece& piece: pieces_)
+    {
+      size_t id = piece.source->index.find(word);
+      if (id != CompactIndex::npos)
+        collect(piece, id, result);
+    }
+    std::sort(result.begin(), result.end(), positionLess());
+    result.erase(std::unique(result.begin(), result.end(), samePosition), result.end());
+    return result;
+  }
+
+  PieceText PieceText::slice(const Position& first, const Position& last) const
+  {
+    Band range{ toLine(first.line), toLine(last.line), { first.column, ANY_COLUMN }, { 0, last.column } };
+    PieceText result;
+    long long line = 0;
+    for (const Piece& piece: pieces_)
+    {
+      Piece part = piece;
+      part.band = intersect(piece.band, pullBack(range, piece.scale, piece.offset));
+      if (part.band.firstLine <= part.band.lastLine && extremeLine(part, line))
+        result.pieces_.push_back(part);
+    }
+    return result;
+  }
+
+  PieceText PieceText::transformed(long long scale, long long offset) const
+  {
+    PieceText result(*this);
+    for (Piece& piece: result.pieces_)
+    {
+      piece.offset = scale * piece.offset + offset;
+      piece.scale *= scale;
+    }
+    return result;
+  }
+
+  void PieceText::append(const PieceText& other)
+  {
+    pieces_.insert(pieces_.end(), other.pieces_.begin(), other.pieces_.end());
+  }
+
+  const CompactIndex& PieceText::materialise()
+  {
+    if (isWhole())
+      return pieces_.front().source->index;
+
+    std::vector< const Source* > sources;
+    std::vector< std::vector< const Piece* > > sourcePieces;
+    for (const Piece& piece: pieces_)
+    {
+      size_t source = std::find(sources.begin(), sources.end(), piece.source.get()) - sources.begin();
+      if (source == sources.size())
+      {
+        sources.push_back(piece.source.get());
+        sourcePieces.emplace_back();
+      }
+      sourcePieces[source].push_back(&piece);
+    }
+
+    struct Cursor
+    {
+      size_t source;
+      size_t id;
+    };
+    auto compare = [&sources](const Cursor& a, const Cursor& b) {
+      return CompactIndex::compareWords(sources[a.source]->index, a.id, sources[b.source]->index, b.id);
+    };
+    auto later = [&compare](const Cursor& a, const Cursor& b) { return compare(a, b) > 0; };
+    std::priority_queue< Cursor, std::vector< Cursor >, decltype(later) > heap(later);
+    for (size_t source = 0; source < sources.size(); ++source)
+    {
+      if (!sources[source]->index.empty())
+        heap.push(Cursor{ source, 0 });
+    }
+
+    CompactIndex result;
+    std::vector< Position > positions;
+    std::vector< unsigned char > bytes;
+    while (!heap.empty())
+    {
+      Cursor first = heap.top();
+      positions.clear();
+      while (!heap.empty() && compare(heap.top(), first) == 0)
+      {
+        Cursor cursor = heap.top();
+        heap.pop();
+        for (const Piece* piece: sourcePieces[cursor.source])
+          collect(*piece, cursor.id, positions);
+        if (cursor.id + 1 < sources[cursor.source]->index.size())
+          heap.push(Cursor{ cursor.source, cursor.id + 1 });
+      }
+      if (positions.empty())
+        continue;
+      std::sort(positions.begin(), positions.end(), positionLess());
+      positions.erase(std::unique(positions.begin(), positions.end(), samePosition), positions.end());
+      bytes.clear();
+      Position last{ 0, 0 };
+      for (const Position& pos: positions)
+      {
+        encodePosition(bytes, last, pos);
+        last = pos;
+      }
+      const CompactIndex& source = sources[first.source]->index;
+      result.appendWord(source.wordData(first.id), source.wordLength(first.id), bytes.data(),
+                        bytes.data() + bytes.size());
+    }
+
+    pieces_.assign(1, Piece{ std::make_shared< const Source >(std::move(result)), wholeBand(), 1, 0 });
+    return pieces_.front().source->index;
+  }
+}
@@ -0,0 +1,71 @@
+#ifndef PIECE_TEXT_HPP
+#define PIECE_TEXT_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "compact_index.hpp"
+#include "position.hpp"
+
+namespace amine
+{
+  // A text made of pieces of shared, immutable indexes. A piece keeps the positions of its source that lie in a
+  // band and moves their lines to scale * line + offset; columns are left as they are. Editing only rewrites the
+  // pieces, queries resolve positions through them, and materialise() flattens them back into one index.
+  class PieceText
+  {
+  public:
+    PieceText();
+    explicit PieceText(CompactIndex index);
+
+    bool empty() const;
+    size_t maxLine() const;
+    size_t lineCount() const;
+    bool hasPosition(const Position& pos) const;
+    bool contains(const std::string& word) const;
+    std::vector< Position > positions(const std::string& word) const;
+
+    // Positions from first to last inclusive, in (line, column) order.
+    PieceText slice(const Position& first, const Position& last) const;
+    PieceText transformed(long long scale, long long offset) const;
+    void append(const PieceText& other);
+
+    const CompactIndex& materialise();
+
+  private:
+    struct Source;
+    struct Columns
+    {
+      size_t first;
+      size_t last;
+    };
+    // Lines firstLine..lastLine of a source; the columns on the two boundary lines are restricted.
+    struct Band
+    {
+      long long firstLine;
+      long long lastLine;
+      Columns onFirst;
+      Columns onLast;
+    };
+    struct Piece
+    {
+      std::shared_ptr< const Source > source;
+      Band band;
+      long long scale;
+      long long offset;
+    };
+
+    std::vector< Piece > pieces_;
+
+    static Band wholeBand();
+    static bool inBand(const Band& band, long long line, size_t column);
+    static Band intersect(const Band& a, const Band& b);
+    static Band pullBack(const Band& band, long long scale, long long offset);
+    static bool lineInBand(const Source& source, size_t lineIdx, const Band& band);
+    static bool extremeLine(const Piece& piece, long long& line);
+    static void collect(const Piece& piece, size_t id, std::vector< Position >& out);
+    bool isWhole() const;
+  };
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef POSITION_HPP
+#define POSITION_HPP
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+
+namespace amine
+{
+  struct Position
+  {
+    size_t line;
+    size_t column;
+  };
+
+  struct positionLess
+  {
+    bool operator()(const Position& a, const Position& b) const;
+  };
+
+  using Index = std::map< std::string, std::set< Position, positionLess > >;
+}
+
+#endif
@@ -1,16 +1,26 @@
 #include "xref.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <exception>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <iterator>
 #include <numeric>
 #include <sstream>
+#include <thread>
 #include <unordered_map>
 #include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
 
 namespace amine
 {
+  const size_t END_LINE = static_cast< size_t >(-1);
+  const size_t END_COLUMN = static_cast< size_t >(-1);
+
   bool positionLess::operator()(const Position& a, const Position& b) const
   {
     return (a.line < b.line) || (a.line == b.line && a.column < b.column);
@@ -24,52 +34,103 @@ namespace amine
 
   CrossRefSystem::CrossRefSystem()
   {
-    indexes_ = std::map< std::string, Index >();
+    indexes_ = std::map< std::string, PieceText >();
   }
 
-  void readLines(std::ifstream& file, std::vector< std::string >& lines)
+  void addLineWords(CompactIndex::Builder& builder, const std::string& line, size_t lineNum)
   {
-    std::string line;
-    if (!std::getline(file, line))
-      return;
-    lines.push_back(line);
-    readLines(file, lines);
+    size_t col = 0;
+    size_t pos = 0;
+    while (pos < line.size())
+    {
+      while (pos < line.size() && std::isspace(static_cast< unsigned char >(line[pos])))
+        ++pos;
+      size_t start = pos;
+      while (pos < line.size() && !std::isspace(static_cast< unsigned char >(line[pos])))
+        ++pos;
+      if (pos > start)
+        builder.add(line.substr(start, pos - start), lineNum, col++);
+    }
   }
 
-  void splitWords(std::istringstream& stream, std::vector< std::string >& words)
+  void CrossRefSystem::buildIndex(const std::string& indexName, const std::string& fileName)
   {
-    std::string word;
-    if (!(stream >> word))
+    std::ifstream file(fileName);
+    if (!file.is_open())
+    {
+      std::cout << "<FILE ERROR>\n";
       return;
-    words.push_back(word);
-    splitWords(stream, words);
-  }
+    }
 
-  void insertWordsRecursive(amine::Index& index, const std::vector< std::string >& words, size_t lineNum, size_t col)
-  {
-    if (col >= words.size())
+    if (indexes_.find(indexName) != indexes_.end())
+    {
+      std::cout << "<WRONG INDEX>\n";
       return;
-    index[words[col]].insert(amine::Position{ lineNum, col });
-    insertWordsRecursive(index, words, lineNum, col + 1);
+    }
+
+    CompactIndex::Builder builder;
+    std::string line;
+    size_t lineNum = 0;
+    while (std::getline(file, line))
+      addLineWords(builder, line, lineNum++);
+    indexes_.insert({ indexName, PieceText(builder.build()) });
   }
 
-  void processLinesRecursive(amine::Index& index, const std::vector< std::string >& lines, size_t lineNum)
+  struct FileIndexTask
+  {
+    std::string fileName;
+    CompactIndex index;
+    size_t lineCount;
+    bool opened;
+  };
+
+  void indexFile(FileIndexTask& task)
   {
-    if (lineNum >= lines.size())
+    std::ifstream file(task.fileName);
+    task.opened = file.is_open();
+    if (!task.opened)
       return;
 
-    std::istringstream stream(lines[lineNum]);
-    std::vector< std::string > words;
-    splitWords(stream, words);
+    CompactIndex::Builder builder;
+    std::string line;
+    while (std::getline(file, line))
+      addLineWords(builder, line, task.lineCount++);
+    task.index = builder.build();
+  }
 
-    insertWordsRecursive(index, words, lineNum, 0);
-    processLinesRecursive(index, lines, lineNum + 1);
+  bool listFiles(const std::string& source, std::vector< std::string >& files)
+  {
+    DIR* dir = opendir(source.c_str());
+    if (dir)
+    {
+      while (dirent* entry = readdir(dir))
+      {
+        std::string path = source + "/" + entry->d_name;
+        struct stat info;
+        if (stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode))
+          files.push_back(path);
+      }
+      closedir(dir);
+      std::sort(files.begin(), files.end());
+      return true;
+    }
+
+    std::ifstream list(source);
+    if (!list.is_open())
+      return false;
+    std::string line;
+    while (std::getline(list, line))
+    {
+      if (!line.empty())
+        files.push_back(line);
+    }
+    return true;
   }
 
-  void CrossRefSystem::buildIndex(const std::string& indexName, const std::string& fileName)
+  void CrossRefSystem::buildIndexFiles(const std::string& indexName, const std::string& source)
   {
-    std::ifstream file(fileName);
-    if (!file.is_open())
+    std::vector< std::string > files;
+    if (!listFiles(source, files) || files.empty())
     {
       std::cout << "<FILE ERROR>\n";
       return;
@@ -81,11 +142,62 @@ namespace amine
       return;
     }
 
-    Index index;
-    std::vector< std::string > lines;
-    readLines(file, lines);
-    processLinesRecursive(index, lines, 0);
-    indexes_.insert({ indexName, index });
+    std::vector< FileIndexTask > tasks(files.size());
+    for (size_t i = 0; i < files.size(); ++i)
+      tasks[i] = FileIndexTask{ files[i], CompactIndex(), 0, false };
+
+    size_t workerCount = std::min< size_t >(std::max(1u, std::thread::hardware_concurrency()), tasks.size());
+    std::atomic< size_t > nextTask(0);
+    std::vector< std::exception_ptr > errors(workerCount);
+    auto work = [&](size_t worker) {
+      try
+      {
+        for (size_t i = nextTask++; i < tasks.size(); i = nextTask++)
+          indexFile(tasks[i]);
+      }
+      catch (...)
+      {
+        errors[worker] = std::current_exception();
+      }
+    };
+    std::vector< std::thread > workers;
+    workers.reserve(workerCount);
+    try
+    {
+      for (size_t worker = 1; worker < workerCount; ++worker)
+        workers.emplace_back(work, worker);
+    }
+    catch (...)
+    {
+      nextTask = tasks.size();
+      for (std::thread& worker: workers)
+        worker.join();
+      throw;
+    }
+    work(0);
+    for (std::thread& worker: workers)
+      worker.join();
+    for (const std::exception_ptr& error: errors)
+    {
+      if (error)
+        std::rethrow_exception(error);
+    }
+
+    std::vector< const CompactIndex* > parts;
+    std::vector< size_t > lineOffsets;
+    size_t lineOffset = 0;
+    for (const FileIndexTask& task: tasks)
+    {
+      if (!task.opened)
+      {
+        std::cout << "<FILE ERROR>\n";
+        return;
+      }
+      parts.push_back(&task.index);
+      lineOffsets.push_back(lineOffset);
+      lineOffset += task.lineCount;
+    }
+    indexes_.insert({ indexName, PieceText(CompactIndex::merge(parts, lineOffsets)) });
   }
 
   void CrossRefSystem::deleteIndex(const std::string& indexName)
@@ -108,9 +220,7 @@ namespace amine
       return;
     }
 
-    const Index& index = indexIt->second;
-    auto wordIt = index.find(word);
-    if (wordIt != index.end())
+    if (indexIt->second.contains(word))
     {
       std::cout << "<YES>\n";
     }
@@ -120,23 +230,11 @@ namespace amine
     }
   }
 
-  void printPositionsRecursive(std::set< amine::Position >::const_iterator it,
-                               std::set< amine::Position >::const_iterator end)
+  void printPositions(PositionReader reader, const char* separator, const char* terminator)
   {
-    if (it == end)
-      return;
-    std::cout << " " << it->line << ":" << it->column;
-    printPositionsRecursive(std::next(it), end);
-  }
-
-  void printIndexRecursive(amine::Index::const_iterator it, amine::Index::const_iterator end)
-  {
-    if (it == end)
-      return;
-    std::cout << it->first << ":";
-    printPositionsRecursive(it->second.begin(), it->second.end());
-    std::cout << "\n";
-    printIndexRecursive(std::next(it), end);
+    Position pos{ 0, 0 };
+    while (reader.next(pos))
+      std::cout << separator << pos.line << ":" << pos.column << terminator;
   }
 
   void CrossRefSystem::printIndex(const std::string& indexName)
@@ -148,8 +246,13 @@ namespace amine
       return;
     }
 
-    const Index& index = it->second;
-    printIndexRecursive(index.begin(), index.end());
+    const CompactIndex& index = it->second.materialise();
+    for (size_t id = 0; id < index.size(); ++id)
+    {
+      std::cout << index.word(id) << ":";
+      printPositions(index.positions(id), " ", "");
+      std::cout << "\n";
+    }
   }
 
   void CrossRefSystem::getPositions(const std::string& indexName, const std::string& word)
@@ -161,25 +264,15 @@ namespace amine
       return;
     }
 
-    const Index& index = it->second;
-    auto wordIt = index.find(word);
-    if (wordIt == index.end())
+    std::vector< Position > positions = it->second.positions(word);
+    if (positions.empty())
     {
       std::cout << "<NOT FOUND>\n";
       return;
     }
 
-    const std::set< Position, positionLess >& positions = wordIt->second;
-
-    std::function< void(std::set< Position >::const_iterator) > printRecursive;
-    printRecursive = [&](std::set< Position >::const_iterator posIt) {
-      if (posIt == positions.end())
-        return;
-      std::cout << posIt->line << ":" << posIt->column << "\n";
-      printRecursive(std::next(posIt));
-    };
-
-    printRecursive(positions.begin());
+    for (const Position& pos: positions)
+      std::cout << pos << "\n";
   }
 
   void CrossRefSystem::mergeTexts(const std::string& newIndex, const std::string& index1, const std::string& index2)
@@ -192,18 +285,11 @@ namespace amine
       return;
     }
 
-    const Index& first = it1->second;
-    const Index& second = it2->second;
-    Index result;
-
-    copyIndexWithOffset(result, first, 0);
-
-    size_t lastLine = getMaxLineRecursive(first.begin(), first.end(), 0);
-    size_t offset = lastLine + 1;
-
-    copyIndexWithOffset(result, second, offset);
+    PieceText result = it1->second;
+    result.append(it2->second.transformed(1, it1->second.maxLine() + 1));
     indexes_[newIndex] = result;
   }
+
   void CrossRefSystem::insertText(const std::string& newIndex, const std::string& baseIndex,
                                   const std::string& insertIndex, size_t afterLine, size_t afterColumn)
   {
@@ -215,62 +301,20 @@ namespace amine
       std::cout << "<WRONG INDEX>\n";
       return;
     }
-    const Index& base = baseIt->second;
-    const Index& toInsert = insertIt->second;
-    Index result;
-
-    std::function< bool(Index::const_iterator) > validatePosRecursive;
-    validatePosRecursive = [&](Index::const_iterator it) -> bool {
-      if (it == base.end())
-        return false;
-      std::function< bool(std::set< Position >::const_iterator) > checkPositions;
-      checkPositions = [&](std::set< Position >::const_iterator posIt) -> bool {
-        if (posIt == it->second.end())
-          return false;
-        if (posIt->line == afterLine && posIt->column == afterColumn)
-          return true;
-        return checkPositions(std::next(posIt));
-      };
-      return checkPositions(it->second.begin()) || validatePosRecursive(std::next(it));
-    };
-
-    if (!validatePosRecursive(base.begin()))
+    const PieceText& base = baseIt->second;
+    const PieceText& toInsert = insertIt->second;
+    if (!base.hasPosition(Position{ afterLine, afterColumn }))
     {
       std::cout << "<INVALID POSITION>\n";
       return;
     }
 
-    Index before, after;
-    std::function< void(Index::const_iterator) > splitRecursive;
-    splitRecursive = [&](Index::const_iterator it) {
-      if (it == base.end())
-        return;
-      const std::string& word = it->first;
-      std::function< void(std::set< Position >::const_iterator) > processPositions;
-      processPositions = [&](std::set< Position >::const_iterator posIt) {
-        if (posIt == it->second.end())
-          return;
-        if (posIt->line < afterLine || (posIt->line == afterLine && posIt->column <= afterColumn))
-          before[word].insert(*posIt);
-        else
-          after[word].insert(*posIt);
-        processPositions(std::next(posIt));
-      };
-
-      processPositions(it->second.begin());
-      splitRecursive(std::next(it));
-    };
-
-    splitRecursive(base.begin());
-
-    copyIndexWithOffset(result, before, 0);
-
-    size_t insertOffset = getMaxLineRecursive(before.begin(), before.end(), 0) + 1;
-    copyIndexWithOffset(result, toInsert, insertOffset);
-
-    size_t finalOffset = insertOffset + getMaxLineRecursive(toInsert.begin(), toInsert.end(), 0) + 1;
-    copyIndexWithOffset(result, after, finalOffset - insertOffset);
-
+    PieceText result = base.slice(Position{ 0, 0 }, Position{ afterLine, afterColumn });
+    PieceText after = base.slice(Position{ afterLine, afterColumn + 1 }, Position{ END_LINE, END_COLUMN });
+    size_t insertOffset = result.maxLine() + 1;
+    size_t afterOffset = toInsert.maxLine() + 1;
+    result.append(toInsert.transformed(1, insertOffset));
+    result.append(after.transformed(1, afterOffset));
     indexes_[newIndex] = result;
   }
 
@@ -283,94 +327,14 @@ namespace amine
       std::cout << "<WRONG INDEX>\n";
       return;
     }
-    const Index& base = baseIt->second;
-    Index result;
     if (startLine > endLine || (startLine == endLine && startCol > endCol))
     {
       std::cout << "<INVALID RANGE>\n";
       return;
     }
-    std::function< void(Index::const_iterator) > extractRecursive;
-    extractRecursive = [&](Index::const_iterator it) {
-      if (it == base.end())
-        return;
-
-      const std::string& word = it->first;
-      const auto& positions = it->second;
-
-      std::function< void(std::set< Position >::const_iterator) > filterPositions;
-      filterPositions = [&](std::set< Position >::const_iterator pit) {
-        if (pit == positions.end())
-          return;
-
-        const auto& pos = *pit;
-        bool insideRange = (pos.line > startLine || (pos.line == startLine && pos.column >= startCol)) &&
-                           (pos.line < endLine || (pos.line == endLine && pos.column <= endCol));
-
-        if (insideRange)
-          result[word].insert(pos);
-
-        filterPositions(std::next(pit));
-      };
-
-      filterPositions(positions.begin());
-      extractRecursive(std::next(it));
-    };
-
-    extractRecursive(base.begin());
-    indexes_[newIndex] = result;
+    indexes_[newIndex] = baseIt->second.slice(Position{ startLine, startCol }, Position{ endLine, endCol });
   }
 
-  void copyIndexWithOffset(amine::Index& target, const amine::Index& source, size_t lineOffset)
-  {
-    if (source.empty())
-      return;
-
-    auto it = source.begin();
-
-    std::function< void(Index::const_iterator) > copyRecursive;
-    copyRecursive = [&](Index::const_iterator iter) {
-      if (iter == source.end())
-        return;
-      const std::string& word = iter->first;
-      const std::set< amine::Position, amine::positionLess >& positions = iter->second;
-
-      std::function< void(std::set< amine::Position >::const_iterator) > insertPositions;
-      insertPositions = [&](std::set< amine::Position >::const_iterator posIt) {
-        if (posIt == positions.end())
-          return;
-
-        amine::Position shifted{ posIt->line + lineOffset, posIt->column };
-        target[word].insert(shifted);
-        insertPositions(std::next(posIt));
-      };
-
-      insertPositions(positions.begin());
-      copyRecursive(std::next(iter));
-    };
-
-    copyRecursive(it);
-  }
-  size_t getMaxLineRecursive(Index::const_iterator iter, Index::const_iterator end, size_t currentMax)
-  {
-    if (iter == end)
-    {
-      return currentMax;
-    }
-    size_t maxInWord = currentMax;
-    std::function< size_t(std::set< Position >::const_iterator, std::set< Position >::const_iterator, size_t) >
-      maxInSet;
-
-    maxInSet = [&](std::set< Position >::const_iterator pit, std::set< Position >::const_iterator pend, size_t curMax) {
-      if (pit == pend)
-        return curMax;
-      size_t nextMax = std::max(curMax, pit->line);
-      return maxInSet(std::next(pit), pend, nextMax);
-    };
-
-    maxInWord = maxInSet(iter->second.begin(), iter->second.end(), maxInWord);
-    return getMaxLineRecursive(std::next(iter), end, maxInWord);
-  }
   void CrossRefSystem::replaceWord(const std::string& indexName, const std::string& oldWord, const std::string& newWord)
   {
     auto it = indexes_.find(indexName);
@@ -380,16 +344,13 @@ namespace amine
       return;
     }
 
-    Index& index = it->second;
-    auto wordIt = index.find(oldWord);
-    if (wordIt == index.end())
+    if (!it->second.contains(oldWord))
     {
       std::cout << "<NOT FOUND>\n";
       return;
     }
 
-    index[newWord] = wordIt->second;
-    index.erase(wordIt);
+    it->second = PieceText(it->second.materialise().withWordReplaced(oldWord, newWord));
   }
   void CrossRefSystem::repeatText(const std::string& newIndex, const std::string& baseIndex, size_t N)
   {
@@ -406,23 +367,11 @@ namespace amine
       return;
     }
 
-    const Index& base = it->second;
-
-    Index result;
-    copyIndexWithOffset(result, base, 0);
-
-    size_t lastLine = getMaxLineRecursive(base.begin(), base.end(), 0) + 1;
-
-    std::function< void(size_t) > repeatRecursive;
-    repeatRecursive = [&](size_t count) {
-      if (count == 1)
-        return;
-
-      copyIndexWithOffset(result, base, lastLine * (count - 1));
-      repeatRecursive(count - 1);
-    };
-
-    repeatRecursive(N);
+    const PieceText& base = it->second;
+    PieceText result = base;
+    size_t lastLine = base.maxLine() + 1;
+    for (size_t copy = 1; copy < N; ++copy)
+      result.append(base.transformed(1, lastLine * copy));
     indexes_[newIndex] = result;
   }
   void CrossRefSystem::swapWords(const std::string& indexName, const std::string& word1, const std::string& word2)
@@ -434,19 +383,13 @@ namespace amine
       return;
     }
 
-    Index& index = it->second;
-    auto word1It = index.find(word1);
-    auto word2It = index.find(word2);
-
-    if (word1It == index.end() || word2It == index.end())
+    if (!it->second.contains(word1) || !it->second.contains(word2))
     {
       std::cout << "<NOT FOUND>\n";
       return;
     }
 
-    std::set< Position, positionLess > temp = word1It->second;
-    index[word1] = word2It->second;
-    index[word2] = temp;
+    it->second = PieceText(it->second.materialise().withWordsSwapped(word1, word2));
   }
   void CrossRefSystem::interleaveLines(const std::string& newIndex, const std::string& index1,
                                        const std::string& index2)
@@ -459,81 +402,18 @@ namespace amine
       return;
     }
 
-    const Index& a = it1->second;
-    const Index& b = it2->second;
-    Index result;
-
-    std::map< size_t, std::vector< std::pair< std::string, size_t > > > linesA;
-    std::map< size_t, std::vector< std::pair< std::string, size_t > > > linesB;
-    std::function< void(Index::const_iterator) > collectLinesARecursive;
-    collectLinesARecursive = [&](Index::const_iterator it) {
-      if (it == a.end())
-        return;
-      const std::string& word = it->first;
-      std::function< void(std::set< Position >::const_iterator) > processPositionsA;
-      processPositionsA = [&](std::set< Position >::const_iterator posIt) {
-        if (posIt == it->second.end())
-          return;
-        linesA[posIt->line].emplace_back(word, posIt->column);
-        processPositionsA(std::next(posIt));
-      };
-      processPositionsA(it->second.begin());
-      collectLinesARecursive(std::next(it));
-    };
-
-    std::function< void(Index::const_iterator) > collectLinesBRecursive;
-    collectLinesBRecursive = [&](Index::const_iterator it) {
-      if (it == b.end())
-        return;
-      const std::string& word = it->first;
-      std::function< void(std::set< Position >::const_iterator) > processPositionsB;
-      processPositionsB = [&](std::set< Position >::const_iterator posIt) {
-        if (posIt == it->second.end())
-          return;
-        linesB[posIt->line].emplace_back(word, posIt->column);
-        processPositionsB(std::next(posIt));
-      };
-      processPositionsB(it->second.begin());
-      collectLinesBRecursive(std::next(it));
-    };
-
-    collectLinesARecursive(a.begin());
-    collectLinesBRecursive(b.begin());
-
-    size_t maxLines = std::max(linesA.size(), linesB.size());
-    size_t outLine = 0;
-
-    std::function< void(size_t) > writeInterleavedRecursive;
-    writeInterleavedRecursive = [&](size_t lineIdx) {
-      if (lineIdx >= maxLines)
-        return;
-
-      auto insertLineRecursive = [&](const auto& src, size_t srcLine) {
-        auto found = src.find(srcLine);
-        if (found != src.end())
-        {
-          const auto& wordCols = found->second;
-          std::function< void(size_t) > processWordCols;
-          processWordCols = [&](size_t idx) {
-            if (idx >= wordCols.size())
-              return;
-            const auto& wordCol = wordCols[idx];
-            result[wordCol.first].insert({ outLine, wordCol.second });
-            processWordCols(idx + 1);
-          };
-          processWordCols(0);
-        }
-      };
-
-      insertLineRecursive(linesA, lineIdx);
-      ++outLine;
-      insertLineRecursive(linesB, lineIdx);
-      ++outLine;
-
-      writeInterleavedRecursive(lineIdx + 1);
-    };
-
-    writeInterleavedRecursive(0);
+    const PieceText& a = it1->second;
+    const PieceText& b = it2->second;
+    // Line i of either text is taken for i below the larger number of occupied lines,
+    // and goes to line 2i (first text) or 2i + 1 (second text).
+    size_t maxLines = std::max(a.lineCount(), b.lineCount());
+    PieceText result;
+    if (maxLines > 0)
+    {
+      Position last{ maxLines - 1, END_COLUMN };
+      result = a.slice(Position{ 0, 0 }, last).transformed(2, 0);
+      result.append(b.slice(Position{ 0, 0 }, last).transformed(2, 1));
+    }
     indexes_[newIndex] = result;
   }
 
@@ -546,41 +426,14 @@ namespace amine
       return;
     }
 
-    const Index& base = it->second;
+    const PieceText& base = it->second;
     if (base.empty())
     {
       std::cout << "<EMPTY>\n";
       return;
     }
 
-    size_t maxLine = getMaxLineRecursive(base.begin(), base.end(), 0);
-    Index result;
-
-    std::function< void(Index::const_iterator) > reverseRecursive;
-    reverseRecursive = [&](Index::const_iterator wordIt) {
-      if (wordIt == base.end())
-        return;
-
-      const std::string& word = wordIt->first;
-      const auto& positions = wordIt->second;
-
-      std::function< void(std::set< Position >::const_iterator) > processSet;
-      processSet = [&](std::set< Position >::const_iterator posIt) {
-        if (posIt == positions.end())
-          return;
-
-        size_t newLine = maxLine - posIt->line;
-        result[word].insert(Position{ newLine, posIt->column });
-
-        processSet(std::next(posIt));
-      };
-
-      processSet(positions.begin());
-      reverseRecursive(std::next(wordIt));
-    };
-
-    reverseRecursive(base.begin());
-    indexes_[newIndex] = result;
+    indexes_[newIndex] = base.transformed(-1, base.maxLine());
   }
 
   void CrossRefSystem::saveIndex(const std::string& indexName, const std::string& filename)
@@ -589,77 +442,59 @@ namespace amine
     if (it == indexes_.end())
       return;
 
-    std::ofstream out(filename);
+    // Written aside and renamed, so saving over the file a loaded index is mapped from is safe.
+    std::string tempName = filename + ".tmp";
+    std::ofstream out(tempName);
     if (!out.is_open())
     {
       std::cout << "<FILE ERROR>\n";
       return;
     }
 
-    const Index& index = it->second;
-
-    std::function< void(Index::const_iterator) > writeWords;
-    writeWords = [&](Index::const_iterator w) {
-      if (w == index.end())
-        return;
-      out << w->first;
-
-      std::function< void(std::set< Position >::const_iterator) > writePos;
-      writePos = [&](std::set< Position >::const_iterator p) {
-        if (p == w->second.end())
-          return;
-        out << " " << p->line << ":" << p->column;
-        writePos(std::next(p));
-      };
-
-      writePos(w->second.begin());
+    const CompactIndex& index = it->second.materialise();
+    for (size_t id = 0; id < index.size(); ++id)
+    {
+      out << index.word(id);
+      PositionReader reader = index.positions(id);
+      Position pos{ 0, 0 };
+      while (reader.next(pos))
+        out << " " << pos.line << ":" << pos.column;
       out << "\n";
-
-      writeWords(std::next(w));
-    };
-
-    writeWords(index.begin());
+    }
+    out.close();
+    if (!out || std::rename(tempName.c_str(), filename.c_str()) != 0)
+    {
+      std::remove(tempName.c_str());
+      std::cout << "<FILE ERROR>\n";
+    }
   }
 
-  void loadRecursive(std::ifstream& in, amine::Index& index, std::string& word)
+  void CrossRefSystem::saveIndexBinary(const std::string& indexName, const std::string& filename)
   {
-    size_t line = 0;
-    size_t col = 0;
-
-    if (!(in >> word))
-      return;
-    std::function< void() > skipSpaces;
-    skipSpaces = [&]() {
-      if (in.peek() != ' ')
-        return;
-      in.get();
-      skipSpaces();
-    };
-    skipSpaces();
-
-    std::string position;
-    if (!(in >> position))
-      return;
-
-    size_t colonPos = position.find(':');
-    if (colonPos == std::string::npos)
+    auto it = indexes_.find(indexName);
+    if (it == indexes_.end())
+    {
+      std::cout << "<WRONG INDEX>\n";
       return;
+    }
 
-    line = std::stoul(position.substr(0, colonPos));
-    col = std::stoul(position.substr(colonPos + 1));
-
-    index[word].insert({ line, col });
+    if (!it->second.materialise().saveBinary(filename))
+      std::cout << "<FILE ERROR>\n";
+  }
 
-    char next = in.peek();
-    if (next == '\n' || next == EOF)
-    {
-      std::string nextWord;
-      loadRecursive(in, index, nextWord);
-    }
-    else
-    {
-      loadRecursive(in, index, word);
-    }
+  bool parsePosition(const std::string& token, Position& pos)
+  {
+    size_t colonPos = token.find(':');
+    if (colonPos == std::string::npos || colonPos == 0 || colonPos + 1 == token.size())
+      return false;
+    const char* digits = "0123456789";
+    if (token.find_first_not_of(digits) != colonPos)
+      return false;
+    if (token.find_first_not_of(digits, colonPos + 1) != std::string::npos)
+      return false;
+    pos.line = std::stoul(token.substr(0, colonPos));
+    pos.column = std::stoul(token.substr(colonPos + 1));
+    return true;
   }
 
   void CrossRefSystem::loadIndex(const std::string& indexName, const std::string& fileName)
@@ -671,10 +506,37 @@ namespace amine
       return;
     }
 
-    Index index;
-    std::string word;
-    loadRecursive(in, index, word);
-    indexes_[indexName] = index;
+    if (CompactIndex::hasBinaryHeader(fileName))
+    {
+      CompactIndex mapped;
+      if (!CompactIndex::mapBinary(fileName, mapped))
+      {
+        std::cout << "<FILE ERROR>\n";
+        return;
+      }
+      indexes_[indexName] = PieceText(std::move(mapped));
+      return;
+    }
+
+    CompactIndex::Builder builder;
+    std::string line;
+    bool valid = true;
+    while (valid && std::getline(in, line))
+    {
+      std::istringstream tokens(line);
+      std::string word;
+      if (!(tokens >> word))
+        continue;
+      std::string token;
+      Position pos{ 0, 0 };
+      while (valid && tokens >> token)
+      {
+        valid = parsePosition(token, pos);
+        if (valid)
+          builder.add(word, pos.line, pos.column);
+      }
+    }
+    indexes_[indexName] = PieceText(builder.build());
   }
 
   void CrossRefSystem::reconstructText(const std::string& indexName, const std::string& filename)
@@ -686,7 +548,7 @@ namespace amine
       return;
     }
 
-    const Index& index = it->second;
+    const Index index = it->second.materialise().toIndex();
     if (index.empty())
     {
       std::cout << "<EMPTY>\n";
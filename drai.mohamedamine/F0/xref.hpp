@@ -1,31 +1,21 @@
 #ifndef XREF_HPP
 #define XREF_HPP
 
+#include <iosfwd>
 #include <map>
-#include <set>
 #include <string>
+#include "piece_text.hpp"
+#include "position.hpp"
 
 namespace amine
 {
-  struct Position
-  {
-    size_t line;
-    size_t column;
-  };
-
-  struct positionLess
-  {
-    bool operator()(const Position& a, const Position& b) const;
-  };
-
-  using Index = std::map< std::string, std::set< Position, positionLess > >;
-
   class CrossRefSystem
   {
   public:
     CrossRefSystem();
 
     void buildIndex(const std::string& indexName, const std::string& filename);
+    void buildIndexFiles(const std::string& indexName, const std::string& source);
     void deleteIndex(const std::string& indexName);
     void containsWord(const std::string& indexName, const std::string& word);
     void printIndex(const std::string& indexName);
@@ -42,15 +32,14 @@ namespace amine
     void swapWords(const std::string& indexName, const std::string& word1, const std::string& word2);
     void reverseText(const std::string& newIndex, const std::string& baseIndex);
     void saveIndex(const std::string& indexName, const std::string& filename);
+    void saveIndexBinary(const std::string& indexName, const std::string& filename);
     void loadIndex(const std::string& indexName, const std::string& filename);
     void reconstructText(const std::string& indexName, const std::string& filename);
 
   private:
-    std::map< std::string, Index > indexes_;
+    std::map< std::string, PieceText > indexes_;
   };
 
-  void copyIndexWithOffset(Index& target, const Index& source, size_t lineOffset);
-  size_t getMaxLineRecursive(Index::const_iterator iter, Index::const_iterator end, size_t currentMax);
   std::ostream& operator<<(std::ostream& out, const Position& pos);
 }
 
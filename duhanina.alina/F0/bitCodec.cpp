@@ -0,0 +1,212 @@
+#include "bitCodec.hpp"
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+  const size_t MIN_BLOCK_SIZE = 1 << 16;
+
+  struct BlockWriter
+  {
+    explicit BlockWriter(duhanina::BitBlock& block):
+      block_(block),
+      acc_(0),
+      filled_(0)
+    {}
+
+    void put(std::uint32_t value, size_t length)
+    {
+      acc_ = (acc_ << length) | value;
+      filled_ += length;
+      while (filled_ >= 8)
+      {
+        filled_ -= 8;
+        block_.bytes.push_back(static_cast< unsigned char >(acc_ >> filled_));
+      }
+      block_.bits += length;
+    }
+
+    void finish()
+    {
+      if (filled_ > 0)
+      {
+        block_.bytes.push_back(static_cast< unsigned char >(acc_ << (8 - filled_)));
+        filled_ = 0;
+      }
+    }
+
+  private:
+    duhanina::BitBlock& block_;
+    std::uint64_t acc_;
+    size_t filled_;
+  };
+}
+
+duhanina::FlatCodeTable::FlatCodeTable(const CodeTable& table):
+  codes_()
+{
+  for (const auto& entry : table.char_to_code)
+  {
+    FlatCode& flat = codes_[static_cast< unsigned char >(entry.first)];
+    flat.code = &entry.second;
+    flat.length = entry.second.size();
+    if (flat.length <= 32)
+    {
+      for (char bit : entry.second)
+      {
+        flat.value = (flat.value << 1) | (bit == '1' ? 1 : 0);
+      }
+    }
+  }
+}
+
+void duhanina::FlatCodeTable::encode(const char* begin, const char* end, BitBlock& block) const
+{
+  BlockWriter writer(block);
+  for (const char* it = begin; it != end; ++it)
+  {
+    const FlatCode& flat = codes_[static_cast< unsigned char >(*it)];
+    if (flat.code == nullptr)
+    {
+      throw std::runtime_error("INVALID_CODES");
+    }
+    if (flat.length <= 32)
+    {
+      writer.put(flat.value, flat.length);
+      continue;
+    }
+    for (char bit : *flat.code)
+    {
+      writer.put(bit == '1' ? 1 : 0, 1);
+    }
+  }
+  writer.finish();
+}
+
+duhanina::DecodeTrie::DecodeTrie(const CodeTable& table):
+  nodes_(1, TrieNode{ { -1, -1 }, -1 })
+{
+  for (const auto& entry : table.code_to_char)
+  {
+    int node = 0;
+    for (char bit : entry.first)
+    {
+      size_t index = bit == '1' ? 1 : 0;
+      if (nodes_[node].child[index] == -1)
+      {
+        nodes_[node].child[index] = static_cast< int >(nodes_.size());
+        nodes_.push_back(TrieNode{ { -1, -1 }, -1 });
+      }
+      node = nodes_[node].child[index];
+    }
+    if (node != 0 && nodes_[node].symbol == -1)
+    {
+      nodes_[node].symbol = static_cast< unsigned char >(entry.second);
+    }
+  }
+}
+
+std::string duhanina::DecodeTrie::decode(const BitBlock& block) const
+{
+  std::string decoded;
+  decoded.reserve(block.bits / 4);
+  int node = 0;
+  for (size_t pos = 0; pos < block.bits; ++pos)
+  {
+    node = nodes_[node].child[(block.bytes[pos / 8] >> (7 - pos % 8)) & 1];
+    if (node == -1)
+    {
+      throw std::runtime_error("INVALID_CODES");
+    }
+    if (nodes_[node].symbol != -1)
+    {
+      decoded += static_cast< char >(nodes_[node].symbol);
+      node = 0;
+    }
+  }
+  if (node != 0)
+  {
+    throw std::runtime_error("INVALID_CODES");
+  }
+  return decoded;
+}
+
+void duhanina::append_bits(BitBlock& dest, const BitBlock& src)
+{
+  size_t shift = dest.bits % 8;
+  dest.bytes.reserve(dest.bytes.size() + src.bytes.size() + 1);
+  if (shift == 0)
+  {
+    dest.bytes.insert(dest.bytes.end(), src.bytes.begin(), src.bytes.end());
+  }
+  else
+  {
+    for (unsigned char byte : src.bytes)
+    {
+      dest.bytes.back() |= static_cast< unsigned char >(byte >> shift);
+      dest.bytes.push_back(static_cast< unsigned char >(byte << (8 - shift)));
+    }
+  }
+  dest.bits += src.bits;
+  dest.bytes.resize((dest.bits + 7) / 8);
+}
+
+size_t duhanina::default_thread_count()
+{
+  return std::max< size_t >(1, std::thread::hardware_concurrency());
+}
+
+duhanina::BitBlock duhanina::encode_parallel(str_t text, const CodeTable& table, size_t threads)
+{
+  FlatCodeTable flat(table);
+  size_t block_count = std::max< size_t >(1, std::min(threads, text.size() / MIN_BLOCK_SIZE));
+  size_t block_size = (text.size() + block_count - 1) / std::max< size_t >(1, block_count);
+  std::vector< BitBlock > blocks(block_count);
+  std::vector< std::exception_ptr > errors(block_count);
+  auto worker = [&](size_t i)
+  {
+    try
+    {
+      size_t begin = std::min(text.size(), i * block_size);
+      size_t end = std::min(text.size(), begin + block_size);
+      blocks[i].bytes.reserve((end - begin) / 2);
+      flat.encode(text.data() + begin, text.data() + end, blocks[i]);
+    }
+    catch (...)
+    {
+      errors[i] = std::current_exception();
+    }
+  };
+  std::vector< std::thread > workers;
+  workers.reserve(block_count);
+  try
+  {
+    for (size_t i = 1; i < block_count; ++i)
+    {
+      workers.emplace_back(worker, i);
+    }
+  }
+  catch (...)
+  {
+    std::for_each(workers.begin(), workers.end(), std::mem_fn(&std::thread::join));
+    throw;
+  }
+  worker(0);
+  std::for_each(workers.begin(), workers.end(), std::mem_fn(&std::thread::join));
+  for (const std::exception_ptr& error : errors)
+  {
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
+  BitBlock result = std::move(blocks[0]);
+  for (size_t i = 1; i < block_count; ++i)
+  {
+    append_bits(result, blocks[i]);
+  }
+  return result;
+}
@@ -0,0 +1,55 @@
+#ifndef BITCODEC_HPP
+#define BITCODEC_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "shannonFano.hpp"
+
+namespace duhanina
+{
+  struct BitBlock
+  {
+    std::vector< unsigned char > bytes;
+    size_t bits = 0;
+  };
+
+  struct FlatCode
+  {
+    std::uint32_t value = 0;
+    size_t length = 0;
+    const std::string* code = nullptr;
+  };
+
+  class FlatCodeTable
+  {
+  public:
+    explicit FlatCodeTable(const CodeTable& table);
+    void encode(const char* begin, const char* end, BitBlock& block) const;
+
+  private:
+    std::array< FlatCode, 256 > codes_;
+  };
+
+  class DecodeTrie
+  {
+  public:
+    explicit DecodeTrie(const CodeTable& table);
+    std::string decode(const BitBlock& block) const;
+
+  private:
+    struct TrieNode
+    {
+      int child[2];
+      int symbol;
+    };
+    std::vector< TrieNode > nodes_;
+  };
+
+  void append_bits(BitBlock& dest, const BitBlock& src);
+  BitBlock encode_parallel(str_t text, const CodeTable& table, size_t threads);
+  size_t default_thread_count();
+}
+
+#endif
@@ -253,38 +253,6 @@ void duhanina::TreeDeleter::operator()(duhanina::Node* node) const
   delete_tree(node);
 }
 
-duhanina::CharEncoder::CharEncoder(const duhanina::CodeTable& table, std::string& result):
-  table_(table),
-  result_(result)
-{}
-
-void duhanina::CharEncoder::operator()(char c) const
-{
-  auto it = table_.char_to_code.find(c);
-  if (it == table_.char_to_code.end())
-  {
-    throw std::runtime_error("INVALID_CODES");
-  }
-  result_ += it->second;
-}
-
-duhanina::CodeAccumulator::CodeAccumulator(std::string& decoded, std::string& current_code, const duhanina::CodeTable& table):
-  decoded_(decoded),
-  current_code_(current_code),
-  table_(table)
-{}
-
-void duhanina::CodeAccumulator::operator()(char bit)
-{
-  current_code_ += bit;
-  auto it = table_.code_to_char.find(current_code_);
-  if (it != table_.code_to_char.end())
-  {
-    decoded_ += it->second;
-    current_code_.clear();
-  }
-}
-
 void duhanina::TableTransformer::operator()(const std::pair< char, std::string >& entry) const
 {
   table_.code_to_char[entry.second] = entry.first;
@@ -301,35 +269,6 @@ void duhanina::SizeTByteWriter::operator()(size_t byte_index) const
   out_.put(byte);
 }
 
-duhanina::BitWriter::BitWriter(std::ofstream& out):
-  out_(out)
-{}
-
-void duhanina::BitWriter::operator()(char bit)
-{
-  if (bit == '1')
-  {
-    buffer_ |= (1 << (7 - bit_pos_));
-  }
-  bit_pos_++;
-  if (bit_pos_ == 8)
-  {
-    out_.put(buffer_);
-    buffer_ = 0;
-    bit_pos_ = 0;
-  }
-}
-
-void duhanina::BitWriter::flush()
-{
-  if (bit_pos_ > 0)
-  {
-    out_.put(buffer_);
-    buffer_ = 0;
-    bit_pos_ = 0;
-  }
-}
-
 duhanina::HeaderReader::HeaderReader(std::ifstream& in, size_t& bit_count):
   in_(in),
   bit_count_(bit_count),
@@ -346,64 +285,6 @@ void duhanina::HeaderReader::operator()(int)
   bit_count_ |= static_cast< size_t >(static_cast< unsigned char >(byte)) << (8 * shift_++);
 }
 
-duhanina::BitHandler::BitHandler(std::string& result, size_t& processed, size_t total_bits):
-  result_(result),
-  processed_(processed),
-  total_bits_(total_bits)
-{}
-
-void duhanina::BitHandler::operator()(size_t bit_pos)
-{
-  if (processed_ < total_bits_)
-  {
-    if (bits_.test(7 - bit_pos))
-    {
-      result_ += '1';
-    }
-    else
-    {
-      result_ += '0';
-    }
-    ++processed_;
-  }
-}
-
-void duhanina::BitHandler::set_bits(const std::bitset< 8 >& bits)
-{
-  bits_ = bits;
-}
-
-duhanina::DataProcessor::DataProcessor(size_t total_bits):
-  total_bits_(total_bits),
-  processed_(0)
-{
-  result_.reserve(total_bits);
-}
-
-void duhanina::DataProcessor::operator()(char byte)
-{
-  if (processed_ >= total_bits_)
-  {
-    return;
-  }
-  std::bitset< 8 > bits(byte);
-  BitHandler handler(result_, processed_, total_bits_);
-  handler.set_bits(std::bitset< 8 >(bits));
-  std::vector< size_t > bit_positions(8);
-  std::iota(bit_positions.begin(), bit_positions.end(), 0);
-  std::for_each(bit_positions.begin(), bit_positions.end(), handler);
-}
-
-std::string duhanina::DataProcessor::get_result() const
-{
-  return result_;
-}
-
-bool duhanina::DataProcessor::is_complete() const
-{
-  return processed_ == total_bits_;
-}
-
 duhanina::TableEntryWriter::TableEntryWriter(std::ofstream& output_stream):
   out_(output_stream)
 {}
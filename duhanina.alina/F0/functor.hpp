@@ -1,7 +1,6 @@
 #ifndef FUNCTOR_HPP
 #define FUNCTOR_HPP
 
-#include <bitset>
 #include <fstream>
 #include <set>
 #include <iterator>
@@ -142,29 +141,6 @@ namespace duhanina
     void operator()(Node* node) const;
   };
 
-  struct CharEncoder
-  {
-  public:
-    explicit CharEncoder(const duhanina::CodeTable& table, std::string& result);
-    void operator()(char c) const;
-
-  private:
-    const CodeTable& table_;
-    std::string& result_;
-  };
-
-  struct CodeAccumulator
-  {
-  public:
-    CodeAccumulator(std::string& decoded, std::string& current_code, const CodeTable& table);
-    void operator()(char bit);
-
-  private:
-    std::string& decoded_;
-    std::string& current_code_;
-    const CodeTable& table_;
-  };
-
   struct SizeTByteWriter
   {
   public:
@@ -176,19 +152,6 @@ namespace duhanina
     size_t value_;
   };
 
-  struct BitWriter
-  {
-  public:
-    explicit BitWriter(std::ofstream& out);
-    void operator()(char bit);
-    void flush();
-
-  private:
-    std::ofstream& out_;
-    char buffer_ = 0;
-    size_t bit_pos_ = 0;
-  };
-
   struct HeaderReader
   {
   public:
@@ -201,34 +164,6 @@ namespace duhanina
     size_t shift_;
   };
 
-  struct DataProcessor
-  {
-  public:
-    DataProcessor(size_t total_bits);
-    void operator()(char byte);
-    std::string get_result() const;
-    bool is_complete() const;
-
-  private:
-    std::string result_;
-    size_t total_bits_;
-    size_t processed_;
-  };
-
-  struct BitHandler
-  {
-  public:
-    BitHandler(std::string& result, size_t& processed, size_t total_bits);
-    void operator()(size_t bit_pos);
-    void set_bits(const std::bitset< 8 >& bits);
-
-  private:
-    std::string& result_;
-    size_t& processed_;
-    size_t total_bits_;
-    std::bitset< 8 > bits_;
-  };
-
   class TableEntryWriter
   {
   public:
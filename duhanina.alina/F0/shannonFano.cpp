@@ -8,6 +8,7 @@
 #include <cmath>
 #include <algorithm>
 #include "functor.hpp"
+#include "bitCodec.hpp"
 
 namespace
 {
@@ -97,68 +98,35 @@ namespace
     }
   }
 
-  std::string encode_text(str_t text, const duhanina::CodeTable& table)
-  {
-    std::string encoded;
-    CharEncoder encoder(table, encoded);
-    try
-    {
-      std::for_each(text.begin(), text.end(), encoder);
-    }
-    catch (const std::runtime_error&)
-    {
-      encoded.clear();
-      throw;
-    }
-    return encoded;
-  }
-
-  std::string decode_text(str_t encoded, const duhanina::CodeTable& table)
-  {
-    std::string decoded;
-    std::string current_code;
-    CodeAccumulator accumulator(decoded, current_code, table);
-    std::for_each(encoded.begin(), encoded.end(), accumulator);
-    if (!current_code.empty())
-    {
-      throw std::runtime_error("INVALID_CODES");
-    }
-    return decoded;
-  }
-
-  void write_bits_to_file(str_t bits, str_t filename)
+  void write_bits_to_file(const duhanina::BitBlock& block, str_t filename)
   {
     std::ofstream out(filename, std::ios::binary);
     if (!out)
     {
       throw std::runtime_error("INVALID_FILE");
     }
-    write_size_t(out, bits.size());
-    BitWriter bit_writer(out);
-    std::for_each(bits.begin(), bits.end(), bit_writer);
-    bit_writer.flush();
+    write_size_t(out, block.bits);
+    out.write(reinterpret_cast< const char* >(block.bytes.data()), block.bytes.size());
   }
 
-  std::string read_bits_from_file(str_t filename)
+  duhanina::BitBlock read_bits_from_file(str_t filename)
   {
     std::ifstream in(filename, std::ios::binary);
     if (!in)
     {
       throw std::runtime_error("FILE_NOT_FOUND");
     }
-    size_t bit_count = 0;
-    HeaderReader header_reader(in, bit_count);
+    duhanina::BitBlock block;
+    HeaderReader header_reader(in, block.bits);
     std::vector< int > dummy(sizeof(size_t));
     std::for_each(dummy.begin(), dummy.end(), header_reader);
-    DataProcessor processor(bit_count);
-    std::istreambuf_iterator< char > begin(in);
-    std::istreambuf_iterator< char > end;
-    std::for_each(begin, end, std::ref(processor));
-    if (!processor.is_complete())
+    size_t byte_count = (block.bits + 7) / 8;
+    block.bytes.resize(byte_count);
+    if (!in.read(reinterpret_cast< char* >(block.bytes.data()), byte_count))
     {
       throw std::runtime_error("TRUNCATED_FILE");
     }
-    return processor.get_result();
+    return block;
   }
 
   void save_code_table(const duhanina::CodeTable& table, str_t filename)
@@ -190,7 +158,7 @@ namespace
     return table;
   }
 
-  void encode_file_impl(str_t input_file, str_t output_file, const duhanina::CodeTable& table, std::ostream& out)
+  void encode_file_impl(str_t input_file, str_t output_file, const duhanina::CodeTable& table, size_t threads, std::ostream& out)
   {
     std::ifstream in(input_file, std::ios::binary);
     if (!in)
@@ -198,10 +166,10 @@ namespace
       throw std::runtime_error("FILE_NOT_FOUND");
     }
     std::string text((std::istreambuf_iterator< char >(in)), std::istreambuf_iterator< char >());
-    std::string encoded = encode_text(text, table);
+    duhanina::BitBlock encoded = encode_parallel(text, table, threads);
     write_bits_to_file(encoded, output_file);
     double original_size = text.size();
-    double compressed_size = std::ceil(encoded.size() / 8.0) + sizeof(size_t);
+    double compressed_size = encoded.bytes.size() + sizeof(size_t);
     double ratio = (compressed_size / original_size) * 100;
     out << "File successfully compressed:\n";
     out << "Original size: " << original_size << " bytes\n";
@@ -211,8 +179,8 @@ namespace
 
   void decode_file_impl(str_t input_file, str_t output_file, const duhanina::CodeTable& table, std::ostream& out)
   {
-    std::string encoded = read_bits_from_file(input_file);
-    std::string decoded = decode_text(encoded, table);
+    duhanina::BitBlock encoded = read_bits_from_file(input_file);
+    std::string decoded = DecodeTrie(table).decode(encoded);
     std::ofstream out_file(output_file);
     if (!out_file)
     {
@@ -310,7 +278,7 @@ void duhanina::encode_file_with_codes(str_t input_file, str_t output_file, str_t
   validate_extension(input_file, TEXT_EXT);
   validate_extension(output_file, COMPRESSED_EXT);
   CodeTable table = load_code_table(codes_file);
-  encode_file_impl(input_file, output_file, table, out);
+  encode_file_impl(input_file, output_file, table, default_thread_count(), out);
 }
 
 
@@ -333,7 +301,23 @@ void duhanina::encode_file(str_t input_file, str_t output_file, str_t encoding_i
   {
     throw std::runtime_error("NO_SUCH_ID");
   }
-  encode_file_impl(input_file, output_file, it->second, out);
+  encode_file_impl(input_file, output_file, it->second, default_thread_count(), out);
+}
+
+void duhanina::encode_file_parallel(str_t input_file, str_t output_file, str_t encoding_id, size_t threads, std::ostream& out)
+{
+  validate_extension(input_file, TEXT_EXT);
+  validate_extension(output_file, COMPRESSED_EXT);
+  if (threads == 0)
+  {
+    throw std::runtime_error("INVALID_THREAD_COUNT");
+  }
+  auto it = encoding_store.find(encoding_id);
+  if (it == encoding_store.end())
+  {
+    throw std::runtime_error("NO_SUCH_ID");
+  }
+  encode_file_impl(input_file, output_file, it->second, threads, out);
 }
 
 
@@ -374,13 +358,13 @@ void duhanina::compare(str_t file1, str_t file2, str_t encod_id1, str_t encod_id
   {
     throw std::runtime_error("IDENTICAL_TEXTS");
   }
-  std::string encoded1 = encode_text(text1, it1->second);
-  std::string encoded2 = encode_text(text2, it2->second);
+  BitBlock encoded1 = encode_parallel(text1, it1->second, default_thread_count());
+  BitBlock encoded2 = encode_parallel(text2, it2->second, default_thread_count());
   double size1_orig = text1.size();
-  double size1_comp = std::ceil(encoded1.size() / 8.0) + sizeof(size_t);
+  double size1_comp = encoded1.bytes.size() + sizeof(size_t);
   double ratio1 = size1_comp / size1_orig;
   double size2_orig = text2.size();
-  double size2_comp = std::ceil(encoded2.size() / 8.0) + sizeof(size_t);
+  double size2_comp = encoded2.bytes.size() + sizeof(size_t);
   double ratio2 = size2_comp / size2_orig;
   out << "Compression efficiency comparison:\n";
   out << "----------------------------------------\n";
@@ -422,6 +406,7 @@ void duhanina::print_help(std::ostream& out)
   out << "encode_file_with_codes <input> <output> <codes_file> - compress file\n";
   out << "decode_file_with_codes <input> <output> <codes_file> - decompress file\n";
   out << "encode_file <input> <output> <encoding_id> - compress file\n";
+  out << "encode_file_parallel <input> <output> <encoding_id> <threads> - compress file using threads\n";
   out << "decode_file <input> <output> <encoding_id> - decompress file\n";
   out << "compare <file1> <file2> <encoding_id1> <encoding_id2> - compare efficiency\n";
   out << "list_encodings - list all encodings\n";
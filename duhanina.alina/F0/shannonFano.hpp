@@ -49,6 +49,7 @@ namespace duhanina
   void encode_file_with_codes(str_t input_file, str_t encoding_name, str_t output_file, std::ostream& out);
   void decode_file_with_codes(str_t input_file, str_t encoding_name, str_t output_file, std::ostream& out);
   void encode_file(str_t input_file, str_t output_file, str_t encoding_name, std::ostream& out);
+  void encode_file_parallel(str_t input_file, str_t output_file, str_t encoding_name, size_t threads, std::ostream& out);
   void decode_file(str_t input_file, str_t output_file, str_t encoding_name, std::ostream& out);
   void compare(str_t file1, str_t file2, str_t encod_name1, str_t encod_name2, std::ostream& out);
   void list_encodings(std::ostream& out);
@@ -0,0 +1,166 @@
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include "bitCodec.hpp"
+
+// Codec benchmarks. Run with
+// `make test-duhanina.alina/F0 TEST_ARGS="--log_level=message -- <megabytes> <max_threads>"`
+// (8 MB and 4 threads by default).
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  size_t benchmark_arg(int index, size_t fallback)
+  {
+    const auto& suite = boost::unit_test::framework::master_test_suite();
+    return suite.argc > index ? std::stoul(suite.argv[index]) : fallback;
+  }
+
+  std::string skewed_text(size_t size)
+  {
+    std::mt19937 generator(11);
+    std::geometric_distribution< int > distribution(0.1);
+    std::string text(size, '\0');
+    std::generate(text.begin(), text.end(), [&]()
+    {
+      return static_cast< char >(distribution(generator) % 256);
+    });
+    return text;
+  }
+
+  duhanina::CodeTable ranked_code_table(const std::string& text)
+  {
+    std::vector< std::pair< size_t, int > > ranks(256);
+    for (int i = 0; i < 256; ++i)
+    {
+      ranks[i] = { 0, i };
+    }
+    for (char c : text)
+    {
+      ++ranks[static_cast< unsigned char >(c)].first;
+    }
+    std::sort(ranks.rbegin(), ranks.rend());
+    duhanina::CodeTable table;
+    table.total_chars = text.size();
+    for (size_t rank = 0; rank < ranks.size() && ranks[rank].first != 0; ++rank)
+    {
+      std::string code;
+      for (size_t n = rank + 1; n != 0; n >>= 1)
+      {
+        code.insert(code.begin(), n & 1 ? '1' : '0');
+      }
+      code.insert(0, code.size() - 1, '0');
+      char symbol = static_cast< char >(ranks[rank].second);
+      table.char_to_code[symbol] = code;
+      table.code_to_char[code] = symbol;
+    }
+    return table;
+  }
+
+  duhanina::BitBlock reference_encode(const std::string& text, const duhanina::CodeTable& table)
+  {
+    duhanina::BitBlock block;
+    for (char c : text)
+    {
+      for (char bit : table.char_to_code.at(c))
+      {
+        if (block.bits % 8 == 0)
+        {
+          block.bytes.push_back(0);
+        }
+        if (bit == '1')
+        {
+          block.bytes.back() |= static_cast< unsigned char >(0x80 >> (block.bits % 8));
+        }
+        ++block.bits;
+      }
+    }
+    return block;
+  }
+
+  std::string map_decode(const duhanina::BitBlock& block, const duhanina::CodeTable& table)
+  {
+    std::string decoded;
+    std::string current_code;
+    for (size_t i = 0; i < block.bits; ++i)
+    {
+      current_code += (block.bytes[i / 8] >> (7 - i % 8)) & 1 ? '1' : '0';
+      auto it = table.code_to_char.find(current_code);
+      if (it != table.code_to_char.end())
+      {
+        decoded += it->second;
+        current_code.clear();
+      }
+    }
+    return decoded;
+  }
+
+  double megabytes_per_second(size_t bytes, Clock::duration elapsed)
+  {
+    return bytes / 1e6 / std::max(std::chrono::duration< double >(elapsed).count(), 1e-9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(parallel_encode_scaling)
+{
+  std::string text = skewed_text(benchmark_arg(1, 8) << 20);
+  duhanina::CodeTable table = ranked_code_table(text);
+  duhanina::BitBlock expected = reference_encode(text, table);
+  size_t max_threads = std::max< size_t >(1, benchmark_arg(2, 4));
+  for (size_t threads = 1; threads <= max_threads; ++threads)
+  {
+    auto start = Clock::now();
+    duhanina::BitBlock block = duhanina::encode_parallel(text, table, threads);
+    auto elapsed = Clock::now() - start;
+    BOOST_CHECK_EQUAL(block.bits, expected.bits);
+    BOOST_CHECK(block.bytes == expected.bytes);
+    BOOST_TEST_MESSAGE("encode " << text.size() << " bytes on " << threads << " threads: "
+        << megabytes_per_second(text.size(), elapsed) << " MB/s");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(parallel_encode_stitches_seven_blocks)
+{
+  std::string text = skewed_text(1 << 20);
+  duhanina::CodeTable table = ranked_code_table(text);
+  duhanina::BitBlock expected = reference_encode(text, table);
+  duhanina::BitBlock block = duhanina::encode_parallel(text, table, 7);
+  BOOST_CHECK_EQUAL(block.bits, expected.bits);
+  BOOST_CHECK(block.bytes == expected.bytes);
+}
+
+BOOST_AUTO_TEST_CASE(trie_decode_throughput)
+{
+  std::string text = skewed_text(benchmark_arg(1, 8) << 20);
+  duhanina::CodeTable table = ranked_code_table(text);
+  duhanina::BitBlock block = reference_encode(text, table);
+
+  auto start = Clock::now();
+  std::string by_map = map_decode(block, table);
+  auto map_time = Clock::now() - start;
+  start = Clock::now();
+  std::string by_trie = duhanina::DecodeTrie(table).decode(block);
+  auto trie_time = Clock::now() - start;
+
+  BOOST_CHECK(by_map == text);
+  BOOST_CHECK(by_trie == text);
+  BOOST_TEST_MESSAGE("decode " << text.size() << " bytes: code_to_char map "
+      << megabytes_per_second(text.size(), map_time) << " MB/s, DecodeTrie "
+      << megabytes_per_second(text.size(), trie_time) << " MB/s");
+}
+
+BOOST_AUTO_TEST_CASE(trie_decode_rejects_partial_code)
+{
+  std::string text = skewed_text(4096);
+  duhanina::CodeTable table = ranked_code_table(text);
+  auto longest = std::max_element(table.char_to_code.begin(), table.char_to_code.end(),
+      [](const std::pair< const char, std::string >& a, const std::pair< const char, std::string >& b)
+      {
+        return a.second.size() < b.second.size();
+      });
+  BOOST_REQUIRE_GT(longest->second.size(), 1);
+  duhanina::BitBlock block = reference_encode(text + longest->first, table);
+  --block.bits;
+  BOOST_CHECK_THROW(duhanina::DecodeTrie(table).decode(block), std::runtime_error);
+}
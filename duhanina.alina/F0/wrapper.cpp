@@ -90,6 +90,19 @@ void duhanina::encode_file_wrapper(std::istream& in, std::ostream& out)
   encode_file(input_file, output_file, encoding_name, out);
 }
 
+void duhanina::encode_file_parallel_wrapper(std::istream& in, std::ostream& out)
+{
+  std::string input_file;
+  std::string output_file;
+  std::string encoding_name;
+  size_t threads = 0;
+  if (!(in >> input_file >> output_file >> encoding_name >> threads))
+  {
+    throw std::runtime_error("Invalid arguments");
+  }
+  encode_file_parallel(input_file, output_file, encoding_name, threads, out);
+}
+
 void duhanina::decode_file_wrapper(std::istream& in, std::ostream& out)
 {
   std::string input_file;
@@ -148,6 +161,7 @@ std::map< std::string, std::function< void() > > duhanina::initialize_commands(s
   commands["encode_file_with_codes"] = std::bind(encode_file_with_codes_wrapper, std::ref(in), std::ref(out));
   commands["decode_file_with_codes"] = std::bind(decode_file_with_codes_wrapper, std::ref(in), std::ref(out));
   commands["encode_file"] = std::bind(encode_file_wrapper, std::ref(in), std::ref(out));
+  commands["encode_file_parallel"] = std::bind(encode_file_parallel_wrapper, std::ref(in), std::ref(out));
   commands["decode_file"] = std::bind(decode_file_wrapper, std::ref(in), std::ref(out));
   commands["compare"] = std::bind(compare_wrapper, std::ref(in), std::ref(out));
   commands["list_encodings"] = std::bind(list_encodings, std::ref(out));
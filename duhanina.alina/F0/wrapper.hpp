@@ -15,6 +15,7 @@ namespace duhanina
   void encode_file_with_codes_wrapper(std::istream&, std::ostream&);
   void decode_file_with_codes_wrapper(std::istream&, std::ostream&);
   void encode_file_wrapper(std::istream&, std::ostream&);
+  void encode_file_parallel_wrapper(std::istream&, std::ostream&);
   void decode_file_wrapper(std::istream&, std::ostream&);
   void compare_wrapper(std::istream&, std::ostream&);
   void suggest_encodings_wrapper(std::istream& in, std::ostream& out);
@@ -1,13 +1,15 @@
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <exception>
 #include <iterator>
 #include <functional>
 #include <stdexcept>
 #include <vector>
 #include <map>
 #include <set>
-#include <numeric>
+#include <memory>
+#include <thread>
 
 #include "TextProcessor.hpp"
 #include "Utility.hpp"
@@ -76,16 +78,60 @@ namespace crossref
       }
     };
 
-    struct LineProcessor
+    // Shards cover consecutive line ranges, so merging them in order keeps postings sorted.
+    const size_t MIN_LINES_PER_SHARD = 4096;
+
+    // Cleaned words of a line, separated by single spaces, as a range of the shard's word buffer.
+    struct WordLine
     {
-      HashTable &table;
-      int &lineNumber;
-      const TextProcessor &processor;
+      int number;
+      size_t offset;
+      size_t length;
+    };
 
-      void operator()(const std::string &line) const
+    struct DictShard
+    {
+      HashTable table;
+      std::string words;
+      std::vector< WordLine > wordLines;
+      std::exception_ptr error;
+    };
+
+    struct ShardBuilder
+    {
+      const TextLines &lines;
+      size_t begin;
+      size_t end;
+      DictShard &shard;
+
+      void operator()() const
       {
-        processor.processLine(table, line, lineNumber);
-        lineNumber++;
+        try
+        {
+          WordScanner scanner;
+          for (size_t i = begin; i < end; ++i)
+          {
+            TextProcessor::processLine(shard.table, lines[i], static_cast< int >(i + 1), scanner);
+            if (scanner.count() == 0)
+            {
+              continue;
+            }
+            size_t offset = shard.words.size();
+            for (size_t j = 0; j < scanner.count(); ++j)
+            {
+              if (j != 0)
+              {
+                shard.words.push_back(' ');
+              }
+              shard.words.append(scanner.word(j), scanner.length(j));
+            }
+            shard.wordLines.push_back(WordLine{static_cast< int >(i + 1), offset, shard.words.size() - offset});
+          }
+        }
+        catch (...)
+        {
+          shard.error = std::current_exception();
+        }
       }
     };
 
@@ -178,64 +224,56 @@ namespace crossref
     validation::checkIdExists(dicts, dict_id, "<DICT ID EXISTS>");
     validation::checkIdNotFound(texts, text_id, "<TEXT NOT FOUND>");
 
-    HashTable table;
-    dictWordOrder.erase(dict_id);
-    auto &wordOrder = dictWordOrder[dict_id];
-
-    int line_num = 1;
     const auto &text_lines = texts.find(text_id)->second;
-
-    struct LineProcessor
+    size_t shardCount = std::max< size_t >(1, std::thread::hardware_concurrency());
+    shardCount = std::min(shardCount, std::max< size_t >(1, text_lines.size() / MIN_LINES_PER_SHARD));
+    size_t step = (text_lines.size() + shardCount - 1) / shardCount;
+
+    std::vector< DictShard > shards(shardCount);
+    std::vector< std::thread > workers;
+    workers.reserve(shardCount - 1);
+    try
     {
-      HashTable &table;
-      std::map< int, std::vector< std::string > > &wordOrder;
-      int &line_num;
-      const TextProcessor &processor;
-
-      void operator()(const std::string &line) const
+      for (size_t i = 1; i < shardCount; ++i)
       {
-        std::vector< std::string > words;
-        crossref::splitRecursive(line, 0, words);
-
-        std::vector< std::string > cleanWords;
-        struct WordCleaner
-        {
-          const TextProcessor &processor;
-          std::vector< std::string > &cleanWords;
-          void operator()(const std::string &word) const
-          {
-            std::string clean = processor.sanitizeWord(word);
-            if (!clean.empty())
-            {
-              cleanWords.push_back(clean);
-            }
-          }
-        };
-        std::for_each(words.begin(), words.end(), WordCleaner{processor, cleanWords});
-
-        struct WordInserter
-        {
-          HashTable &table;
-          int line_num;
-          void operator()(const std::string &word) const
-          {
-            table.insert(word, line_num);
-          }
-        };
-        std::for_each(cleanWords.begin(), cleanWords.end(), WordInserter{table, line_num});
+        size_t begin = std::min(i * step, text_lines.size());
+        size_t end = std::min(begin + step, text_lines.size());
+        workers.emplace_back(ShardBuilder{text_lines, begin, end, shards[i]});
+      }
+    }
+    catch (...)
+    {
+      std::for_each(workers.begin(), workers.end(), std::mem_fn(&std::thread::join));
+      throw;
+    }
+    ShardBuilder{text_lines, 0, std::min(step, text_lines.size()), shards[0]}();
+    std::for_each(workers.begin(), workers.end(), std::mem_fn(&std::thread::join));
 
-        if (!cleanWords.empty())
-        {
-          wordOrder[line_num] = cleanWords;
-        }
-        line_num++;
+    for (const DictShard &shard: shards)
+    {
+      if (shard.error)
+      {
+        std::rethrow_exception(shard.error);
       }
-    };
+    }
 
-    LineProcessor processor{table, wordOrder, line_num, *this};
-    std::for_each(text_lines.begin(), text_lines.end(), processor);
+    HashTable &table = shards[0].table;
+    std::map< int, LineSlice > wordOrder;
+    for (size_t i = 0; i < shardCount; ++i)
+    {
+      if (i != 0)
+      {
+        table.merge(std::move(shards[i].table));
+      }
+      auto buffer = std::make_shared< const std::string >(std::move(shards[i].words));
+      for (const WordLine &line: shards[i].wordLines)
+      {
+        wordOrder.emplace_hint(wordOrder.end(), line.number, LineSlice(buffer, line.offset, line.length));
+      }
+    }
 
-    dicts[dict_id] = table;
+    dictWordOrder[dict_id] = std::move(wordOrder);
+    dicts[dict_id] = std::move(table);
   }
 
   void TextProcessor::showDict(const std::string &dict_id) const
@@ -328,34 +366,48 @@ namespace crossref
     {
       std::vector< std::string > &output;
 
-      void operator()(const std::pair< const int, std::vector< std::string > > &line) const
+      void operator()(const std::pair< const int, LineSlice > &line) const
       {
-        std::vector< std::string > unique_words;
-        struct UniqueInserter
+        using Word = std::pair< const char *, size_t >;
+        std::vector< Word > unique_words;
+        const char *data = line.second.data();
+        size_t size = line.second.size();
+        size_t start = 0;
+        while (start < size)
         {
-          std::vector< std::string > &unique_words;
-          void operator()(const std::string &word) const
+          size_t end = start;
+          while (end < size && data[end] != ' ')
+          {
+            ++end;
+          }
+          Word word(data + start, end - start);
+          struct SameWord
           {
-            if (std::find(unique_words.begin(), unique_words.end(), word) == unique_words.end())
+            const Word &word;
+            bool operator()(const Word &other) const
             {
-              unique_words.push_back(word);
+              return other.second == word.second && std::equal(word.first, word.first + word.second, other.first);
             }
-          }
-        };
-        std::for_each(line.second.begin(), line.second.end(), UniqueInserter{unique_words});
-
-        struct Concatenator
-        {
-          std::string operator()(const std::string &a, const std::string &b) const
+          };
+          if (std::find_if(unique_words.begin(), unique_words.end(), SameWord{word}) == unique_words.end())
           {
-            return a + " " + b;
+            unique_words.push_back(word);
           }
-        };
+          start = end + 1;
+        }
 
         if (!unique_words.empty())
         {
-          std::string line_text =
-              std::accumulate(std::next(unique_words.begin()), unique_words.end(), unique_words[0], Concatenator{});
+          std::string line_text;
+          line_text.reserve(size);
+          for (const Word &word: unique_words)
+          {
+            if (!line_text.empty())
+            {
+              line_text.push_back(' ');
+            }
+            line_text.append(word.first, word.second);
+          }
           output.push_back(line_text);
         }
       }
@@ -364,7 +416,7 @@ namespace crossref
     LineProcessor processor{xref_lines};
     std::for_each(wordOrder.begin(), wordOrder.end(), processor);
 
-    texts[new_text_id] = xref_lines;
+    texts[new_text_id] = packLines(xref_lines);
   }
 
   void TextProcessor::deleteDict(const std::string &dict_id)
@@ -1,43 +1,22 @@
 #include "HashTable.hpp"
 
 #include <algorithm>
-#include <cmath>
+#include <iterator>
 #include <stdexcept>
-#include <vector>
-#include <list>
-#include <numeric>
 
 namespace
 {
 
-  bool isPrimeRecursive(size_t n, size_t i)
-  {
-    if (i * i > n)
-    {
-      return false;
-    }
-    if (n % i == 0 || n % (i + 2) == 0)
-    {
-      return true;
-    }
-    return isPrimeRecursive(n, i + 6);
-  }
+  const size_t NOT_FOUND = static_cast< size_t >(-1);
 
-  bool isPrime(size_t n)
+  size_t slotCountFor(size_t items)
   {
-    if (n <= 1)
-    {
-      return false;
-    }
-    if (n <= 3)
+    size_t count = 8;
+    while (count - count / 8 <= items)
     {
-      return true;
+      count *= 2;
     }
-    if (n % 2 == 0 || n % 3 == 0)
-    {
-      return false;
-    }
-    return !isPrimeRecursive(n, 5);
+    return count;
   }
 
 }
@@ -45,156 +24,187 @@ namespace
 namespace crossref
 {
 
-  HashTable::RehashHelper::RehashHelper(HashTable *t):
-    table(t)
-  {}
-  HashTable::EmplaceHelper::EmplaceHelper(decltype(entries) &e):
-    entries(e)
+  HashTable::HashTable(size_t size):
+    slots(slotCountFor(size)),
+    entries(),
+    mask(slots.size() - 1)
   {}
 
-  void HashTable::RehashHelper::operator()(const HashEntry &entry) const
+  uint64_t HashTable::hash(const char *key, size_t length)
   {
-    if (entry.isActive && !entry.word.empty())
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i)
     {
-      struct InsertLine
-      {
-        HashTable *table;
-        std::string word;
-        InsertLine(HashTable *t, const std::string &w):
-          table(t),
-          word(w)
-        {}
-        void operator()(int line) const
-        {
-          table->insert(word, line);
-        }
-      };
-
-      std::for_each(entry.lines.begin(), entry.lines.end(), InsertLine(table, entry.word));
+      h = (h ^ static_cast< unsigned char >(key[i])) * 1099511628211ULL;
     }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
   }
 
-  void HashTable::EmplaceHelper::operator()(const HashEntry &entry) const
+  size_t HashTable::findSlot(const char *key, size_t length, uint64_t keyHash) const
   {
-    if (entry.isActive && !entry.word.empty())
+    size_t pos = keyHash & mask;
+    for (uint32_t distance = 1;; ++distance)
     {
-      entries.emplace_back(entry.word, std::vector< int >(entry.lines.begin(), entry.lines.end()));
+      const Slot &slot = slots[pos];
+      if (slot.distance < distance)
+      {
+        return NOT_FOUND;
+      }
+      if (slot.hash == keyHash && entries[slot.entry].word.compare(0, std::string::npos, key, length) == 0)
+      {
+        return pos;
+      }
+      pos = (pos + 1) & mask;
     }
   }
 
-  void HashTable::ClearHelper::operator()(HashEntry &entry) const
+  size_t HashTable::placeEntry(uint32_t entry, uint64_t keyHash)
   {
-    entry.word.clear();
-    entry.lines.clear();
-    entry.isActive = false;
+    Slot carried{1, entry, keyHash};
+    size_t pos = keyHash & mask;
+    size_t placed = NOT_FOUND;
+    while (true)
+    {
+      Slot &slot = slots[pos];
+      if (slot.distance == 0)
+      {
+        slot = carried;
+        return placed == NOT_FOUND ? pos : placed;
+      }
+      if (slot.distance < carried.distance)
+      {
+        std::swap(slot, carried);
+        if (placed == NOT_FOUND)
+        {
+          placed = pos;
+        }
+      }
+      ++carried.distance;
+      pos = (pos + 1) & mask;
+    }
   }
 
-  HashTable::HashTable(size_t size):
-    table(size),
-    itemCount(0)
-  {}
-
-  struct HashAccumulator
+  void HashTable::eraseSlot(size_t slot)
   {
-    size_t operator()(size_t hashValue, unsigned char c) const
+    size_t next = (slot + 1) & mask;
+    while (slots[next].distance > 1)
     {
-      return (hashValue * 31) + c;
+      slots[slot] = slots[next];
+      --slots[slot].distance;
+      slot = next;
+      next = (next + 1) & mask;
     }
-  };
+    slots[slot] = Slot{0, 0, 0};
+  }
 
-  size_t HashTable::hash(const std::string &key) const
+  void HashTable::rehash(size_t slotCount)
   {
-    size_t init = 0;
-    return std::accumulate(key.begin(), key.end(), init, HashAccumulator()) % table.size();
+    slots.assign(slotCount, Slot{0, 0, 0});
+    mask = slotCount - 1;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+      placeEntry(static_cast< uint32_t >(i), entries[i].hash);
+    }
   }
 
-  size_t HashTable::findPosition(const std::string &key) const
+  void HashTable::insert(const std::string &key, int line)
   {
-    return findPosition(key, hash(key), 0);
+    insert(key.data(), key.size(), line);
   }
 
-  size_t HashTable::findPosition(const std::string &key, size_t current, size_t i) const
+  void HashTable::insert(const char *key, size_t length, int line)
   {
-    if (!table[current].isActive || table[current].word == key)
+    uint64_t keyHash = hash(key, length);
+    size_t pos = findSlot(key, length, keyHash);
+    if (pos == NOT_FOUND)
     {
-      return current;
-    }
-    if (i >= table.size())
-    {
-      return current;
+      if (entries.size() + 1 > slots.size() - slots.size() / 8)
+      {
+        rehash(slots.size() * 2);
+      }
+      entries.push_back(HashEntry{std::string(key, length), {}, keyHash});
+      pos = placeEntry(static_cast< uint32_t >(entries.size() - 1), keyHash);
     }
 
-    size_t next_i = i + 1;
-    size_t next = (current + next_i * next_i) % table.size();
-    return findPosition(key, next, next_i);
-  }
-
-  size_t HashTable::nextPrime(size_t n) const
-  {
-    if (n % 2 == 0)
+    std::vector< int > &lines = entries[slots[pos].entry].lines;
+    if (lines.empty() || lines.back() < line)
     {
-      n++;
+      lines.push_back(line);
+      return;
     }
-    if (isPrime(n))
+    auto it = std::lower_bound(lines.begin(), lines.end(), line);
+    if (*it != line)
     {
-      return n;
+      lines.insert(it, line);
     }
-    return nextPrime(n + 2);
   }
 
-  void HashTable::rehash()
-  {
-    std::vector< HashEntry > oldTable = std::move(table);
-    table = std::vector< HashEntry >(nextPrime(oldTable.size() * 2));
-    itemCount = 0;
-
-    std::for_each(oldTable.begin(), oldTable.end(), RehashHelper(this));
-  }
-
-  void HashTable::insert(const std::string &key, int line)
+  void HashTable::remove(const std::string &key)
   {
-    if (itemCount >= table.size() * 0.75)
+    size_t pos = findSlot(key.data(), key.size(), hash(key.data(), key.size()));
+    if (pos == NOT_FOUND)
     {
-      rehash();
+      return;
     }
 
-    size_t pos = findPosition(key);
-
-    if (!table[pos].isActive)
-    {
-      table[pos].word = key;
-      table[pos].isActive = true;
-      itemCount++;
-    }
+    uint32_t removed = slots[pos].entry;
+    eraseSlot(pos);
 
-    if (std::find(table[pos].lines.begin(), table[pos].lines.end(), line) == table[pos].lines.end())
+    uint32_t last = static_cast< uint32_t >(entries.size() - 1);
+    if (removed != last)
     {
-      table[pos].lines.push_back(line);
-      table[pos].lines.sort();
+      const std::string &movedWord = entries[last].word;
+      size_t moved = findSlot(movedWord.data(), movedWord.size(), entries[last].hash);
+      slots[moved].entry = removed;
+      entries[removed] = std::move(entries[last]);
     }
+    entries.pop_back();
   }
 
-  void HashTable::remove(const std::string &key)
+  void HashTable::merge(HashTable &&other)
   {
-    size_t pos = findPosition(key);
-
-    if (table[pos].isActive && table[pos].word == key)
+    for (HashEntry &entry: other.entries)
     {
-      table[pos].isActive = false;
-      table[pos].lines.clear();
-      itemCount--;
+      size_t pos = findSlot(entry.word.data(), entry.word.size(), entry.hash);
+      if (pos == NOT_FOUND)
+      {
+        if (entries.size() + 1 > slots.size() - slots.size() / 8)
+        {
+          rehash(slots.size() * 2);
+        }
+        uint64_t keyHash = entry.hash;
+        entries.push_back(std::move(entry));
+        placeEntry(static_cast< uint32_t >(entries.size() - 1), keyHash);
+        continue;
+      }
+
+      std::vector< int > &lines = entries[slots[pos].entry].lines;
+      if (entry.lines.empty() || lines.back() < entry.lines.front())
+      {
+        lines.insert(lines.end(), entry.lines.begin(), entry.lines.end());
+        continue;
+      }
+      std::vector< int > merged;
+      merged.reserve(lines.size() + entry.lines.size());
+      std::set_union(lines.begin(), lines.end(), entry.lines.begin(), entry.lines.end(), std::back_inserter(merged));
+      lines.swap(merged);
     }
+    other.clear();
   }
 
   std::vector< int > HashTable::find(const std::string &key) const
   {
-    size_t pos = findPosition(key);
-
-    if (table[pos].isActive && table[pos].word == key)
+    size_t pos = findSlot(key.data(), key.size(), hash(key.data(), key.size()));
+    if (pos == NOT_FOUND)
     {
-      return std::vector< int >(table[pos].lines.begin(), table[pos].lines.end());
+      return {};
     }
-    return {};
+    return entries[slots[pos].entry].lines;
   }
 
   struct HashTable::EntryComparator
@@ -208,33 +218,36 @@ namespace crossref
 
   std::vector< std::pair< std::string, std::vector< int > > > HashTable::getSortedEntries() const
   {
-    std::vector< std::pair< std::string, std::vector< int > > > entries;
-
-    std::for_each(table.begin(), table.end(), EmplaceHelper(entries));
+    std::vector< std::pair< std::string, std::vector< int > > > result;
+    result.reserve(entries.size());
+    for (const HashEntry &entry: entries)
+    {
+      result.emplace_back(entry.word, entry.lines);
+    }
 
-    std::sort(entries.begin(), entries.end(), EntryComparator());
-    return entries;
+    std::sort(result.begin(), result.end(), EntryComparator());
+    return result;
   }
 
   void HashTable::clear()
   {
-    std::for_each(table.begin(), table.end(), ClearHelper());
-    itemCount = 0;
+    std::fill(slots.begin(), slots.end(), Slot{0, 0, 0});
+    entries.clear();
   }
 
   bool HashTable::isEmpty() const
   {
-    return itemCount == 0;
+    return entries.empty();
   }
 
   size_t HashTable::size() const
   {
-    return itemCount;
+    return entries.size();
   }
 
   size_t HashTable::capacity() const
   {
-    return table.size();
+    return slots.size();
   }
 
 }
@@ -1,9 +1,9 @@
 #ifndef HASH_TABLE_H
 #define HASH_TABLE_H
 
+#include <cstdint>
 #include <vector>
 #include <string>
-#include <list>
 #include <utility>
 
 namespace crossref
@@ -11,14 +11,12 @@ namespace crossref
 
   class HashTable
   {
-    struct RehashHelper;
-    struct EmplaceHelper;
-    struct ClearHelper;
-
   public:
     explicit HashTable(size_t size = 101);
     void insert(const std::string &key, int line);
+    void insert(const char *key, size_t length, int line);
     void remove(const std::string &key);
+    void merge(HashTable &&other);
     std::vector< int > find(const std::string &key) const;
     std::vector< std::pair< std::string, std::vector< int > > > getSortedEntries() const;
     void clear();
@@ -31,42 +29,27 @@ namespace crossref
     struct HashEntry
     {
       std::string word;
-      std::list< int > lines;
-      bool isActive;
+      std::vector< int > lines;
+      uint64_t hash;
     };
 
-    std::vector< HashEntry > table;
-    size_t itemCount;
-
-    size_t findPosition(const std::string &key) const;
-    size_t findPosition(const std::string &key, size_t current, size_t i) const;
-    size_t nextPrime(size_t n) const;
-
-    void rehash();
-    size_t hash(const std::string &key) const;
-
-    friend struct RehashHelper;
-    friend struct EmplaceHelper;
-    friend struct ClearHelper;
-  };
-
-  struct HashTable::RehashHelper
-  {
-    HashTable *table;
-    RehashHelper(HashTable *t);
-    void operator()(const HashEntry &entry) const;
-  };
+    // Robin Hood slot: distance is the probe length plus one, zero marks an empty slot.
+    struct Slot
+    {
+      uint32_t distance;
+      uint32_t entry;
+      uint64_t hash;
+    };
 
-  struct HashTable::EmplaceHelper
-  {
-    std::vector< std::pair< std::string, std::vector< int > > > &entries;
-    EmplaceHelper(decltype(entries) &e);
-    void operator()(const HashEntry &entry) const;
-  };
+    std::vector< Slot > slots;
+    std::vector< HashEntry > entries;
+    size_t mask;
 
-  struct HashTable::ClearHelper
-  {
-    void operator()(HashEntry &entry) const;
+    size_t findSlot(const char *key, size_t length, uint64_t keyHash) const;
+    size_t placeEntry(uint32_t entry, uint64_t keyHash);
+    void eraseSlot(size_t slot);
+    void rehash(size_t slotCount);
+    static uint64_t hash(const char *key, size_t length);
   };
 
 }
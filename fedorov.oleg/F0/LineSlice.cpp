@@ -0,0 +1,76 @@
+#include "LineSlice.hpp"
+
+#include <ostream>
+
+namespace crossref
+{
+
+  LineSlice::LineSlice(const std::shared_ptr< const std::string > &buffer, size_t offset, size_t length):
+    buffer_(buffer),
+    offset_(offset),
+    length_(length)
+  {}
+
+  const char *LineSlice::data() const
+  {
+    return buffer_->data() + offset_;
+  }
+
+  size_t LineSlice::size() const
+  {
+    return length_;
+  }
+
+  std::string LineSlice::str() const
+  {
+    return std::string(data(), length_);
+  }
+
+  std::ostream &operator<<(std::ostream &os, const LineSlice &line)
+  {
+    return os.write(line.data(), line.size());
+  }
+
+  TextLines splitLines(const std::shared_ptr< const std::string > &buffer)
+  {
+    TextLines lines;
+    size_t pos = 0;
+    while (pos < buffer->size())
+    {
+      size_t end = buffer->find('\n', pos);
+      if (end == std::string::npos)
+      {
+        end = buffer->size();
+      }
+      lines.emplace_back(buffer, pos, end - pos);
+      pos = end + 1;
+    }
+    return lines;
+  }
+
+  TextLines packLines(const std::vector< std::string > &lines)
+  {
+    size_t total = 0;
+    for (const std::string &line: lines)
+    {
+      total += line.size() + 1;
+    }
+    std::string joined;
+    joined.reserve(total);
+    for (const std::string &line: lines)
+    {
+      joined.append(line).push_back('\n');
+    }
+    auto buffer = std::make_shared< const std::string >(std::move(joined));
+
+    TextLines result;
+    result.reserve(lines.size());
+    size_t offset = 0;
+    for (const std::string &line: lines)
+    {
+      result.emplace_back(buffer, offset, line.size());
+      offset += line.size() + 1;
+    }
+    return result;
+  }
+}
@@ -0,0 +1,35 @@
+#ifndef LINE_SLICE_HPP
+#define LINE_SLICE_HPP
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace crossref
+{
+
+  // A line of text stored as a view into an immutable buffer shared between texts.
+  class LineSlice
+  {
+  public:
+    LineSlice(const std::shared_ptr< const std::string > &buffer, size_t offset, size_t length);
+
+    const char *data() const;
+    size_t size() const;
+    std::string str() const;
+
+  private:
+    std::shared_ptr< const std::string > buffer_;
+    size_t offset_;
+    size_t length_;
+  };
+
+  using TextLines = std::vector< LineSlice >;
+
+  std::ostream &operator<<(std::ostream &os, const LineSlice &line);
+  TextLines splitLines(const std::shared_ptr< const std::string > &buffer);
+  TextLines packLines(const std::vector< std::string > &lines);
+}
+
+#endif
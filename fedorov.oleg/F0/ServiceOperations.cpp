@@ -23,8 +23,10 @@ namespace crossref
     checkIdNotFound(texts, text_id2, "<TEXT NOT FOUND>");
     checkIdExists(texts, new_text_id, "<TEXT ID EXISTS>");
 
-    std::set< std::string > set1(it1->second.begin(), it1->second.end());
-    std::set< std::string > set2(it2->second.begin(), it2->second.end());
+    std::set< std::string > set1;
+    std::set< std::string > set2;
+    std::transform(it1->second.begin(), it1->second.end(), std::inserter(set1, set1.end()), std::mem_fn(&LineSlice::str));
+    std::transform(it2->second.begin(), it2->second.end(), std::inserter(set2, set2.end()), std::mem_fn(&LineSlice::str));
 
     std::vector< std::string > common;
     std::set_intersection(set1.begin(), set1.end(), set2.begin(), set2.end(), std::back_inserter(common));
@@ -34,7 +36,7 @@ namespace crossref
       throw std::runtime_error("<NO COMMON LINES>");
     }
 
-    texts[new_text_id] = common;
+    texts[new_text_id] = packLines(common);
   }
 
   void TextProcessor::clearAll()
@@ -22,7 +22,7 @@ namespace crossref
       LinePrinter():
         count(1)
       {}
-      void operator()(const std::string &line) const
+      void operator()(const LineSlice &line) const
       {
         std::cout << count++ << ": " << line << '\n';
       }
@@ -64,14 +64,14 @@ namespace crossref
         }
       };
 
-      std::string operator()(const std::string &line) const
+      std::string operator()(const LineSlice &line) const
       {
         if (old_word.empty())
         {
-          return line;
+          return line.str();
         }
 
-        Replacer replacer(*this, line);
+        Replacer replacer(*this, line.str());
         replacer();
         return replacer.result;
       }
@@ -89,11 +89,11 @@ namespace crossref
         current_line(start)
       {}
 
-      void operator()(const std::string &line) const
+      void operator()(const LineSlice &line) const
       {
-        if (line.find(pattern) == 0)
+        if (line.size() >= pattern.size() && std::equal(pattern.begin(), pattern.end(), line.data()))
         {
-          headers.push_back(line + " (строка " + std::to_string(current_line) + ")");
+          headers.push_back(line.str() + " (строка " + std::to_string(current_line) + ")");
         }
         current_line++;
       }
@@ -122,7 +122,7 @@ namespace crossref
       NamePrinter():
         first(true)
       {}
-      void operator()(const std::pair< std::string, std::vector< std::string > > &item)
+      void operator()(const std::pair< const std::string, TextLines > &item)
       {
         if (!first)
         {
@@ -158,11 +158,14 @@ namespace crossref
     validation::checkIdNotFound(texts, text_id1, "<TEXT NOT FOUND>");
     validation::checkIdNotFound(texts, text_id2, "<TEXT NOT FOUND>");
 
-    std::vector< std::string > new_text;
-    std::copy(texts[text_id1].begin(), texts[text_id1].end(), std::back_inserter(new_text));
-    std::copy(texts[text_id2].begin(), texts[text_id2].end(), std::back_inserter(new_text));
+    const TextLines &first = texts[text_id1];
+    const TextLines &second = texts[text_id2];
+    TextLines new_text;
+    new_text.reserve(first.size() + second.size());
+    std::copy(first.begin(), first.end(), std::back_inserter(new_text));
+    std::copy(second.begin(), second.end(), std::back_inserter(new_text));
 
-    texts[new_text_id] = new_text;
+    texts[new_text_id] = std::move(new_text);
   }
 
   void TextProcessor::extractLines(const std::string &new_text_id,
@@ -176,10 +179,9 @@ namespace crossref
 
     validation::checkLineRange(start_line, end_line, it->second.size());
 
-    std::vector< std::string > extracted;
-    std::copy(it->second.begin() + start_line - 1, it->second.begin() + end_line, std::back_inserter(extracted));
+    TextLines extracted(it->second.begin() + start_line - 1, it->second.begin() + end_line);
 
-    texts[new_text_id] = extracted;
+    texts[new_text_id] = std::move(extracted);
   }
 
   void TextProcessor::replaceWords(const std::string &text_id, const std::string &old_word, const std::string &new_word)
@@ -191,7 +193,7 @@ namespace crossref
     std::vector< std::string > updated;
     std::transform(it->second.begin(), it->second.end(), std::back_inserter(updated), replacer);
 
-    it->second = updated;
+    it->second = packLines(updated);
   }
 
   void TextProcessor::extractHeaders(const std::string &new_text_id,
@@ -212,7 +214,7 @@ namespace crossref
       throw std::runtime_error("<PATTERN NOT FOUND>");
     }
 
-    texts[new_text_id] = headers;
+    texts[new_text_id] = packLines(headers);
   }
 
   void TextProcessor::duplicateTextSection(
@@ -225,18 +227,18 @@ namespace crossref
     validation::checkLineRange(start_line, end_line, it_src->second.size());
     validation::checkPositive(times, "TIMES");
 
-    std::vector< std::string > section;
+    TextLines section;
     auto start = it_src->second.begin() + start_line - 1;
     auto end = it_src->second.begin() + end_line;
 
     struct SectionCopier
     {
-      std::vector< std::string > &section;
+      TextLines &section;
       decltype(start) src_start;
       decltype(start) src_end;
       int remaining;
 
-      SectionCopier(std::vector< std::string > &s, decltype(start) start_it, decltype(start) end_it, int rem):
+      SectionCopier(TextLines &s, decltype(start) start_it, decltype(start) end_it, int rem):
         section(s),
         src_start(start_it),
         src_end(end_it),
@@ -256,10 +258,11 @@ namespace crossref
       }
     };
 
+    section.reserve(static_cast< size_t >(end - start) * static_cast< size_t >(times));
     SectionCopier copier(section, start, end, times);
     copier();
 
-    texts[new_text_id] = section;
+    texts[new_text_id] = std::move(section);
   }
   void TextProcessor::listTexts() const
   {
@@ -6,6 +6,8 @@
 #include <map>
 
 #include "HashTable.hpp"
+#include "LineSlice.hpp"
+#include "Tokenizer.hpp"
 
 namespace crossref
 {
@@ -37,16 +39,12 @@ namespace crossref
     void findCommonLines(const std::string &new_text_id, const std::string &text_id1, const std::string &text_id2);
     void clearAll();
 
-    static std::string sanitizeWord(std::string word);
-    void processLine(HashTable &table, const std::string &line, int lineNumber) const;
+    static void processLine(HashTable &table, const LineSlice &line, int lineNumber, WordScanner &scanner);
 
   private:
-    std::map< std::string, std::vector< std::string > > texts;
+    std::map< std::string, TextLines > texts;
     std::map< std::string, HashTable > dicts;
-    std::map< std::string, std::map< int, std::vector< std::string > > > dictWordOrder;
-
-    static bool isNotAlpha(unsigned char c);
-    static char toLower(char c);
+    std::map< std::string, std::map< int, LineSlice > > dictWordOrder;
   };
 
 }
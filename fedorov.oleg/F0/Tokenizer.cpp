@@ -31,6 +31,24 @@ namespace crossref
         }
       }
     };
+
+    // Maps every byte to its lower-case letter, or to zero when it is not an ASCII letter.
+    struct LetterTable
+    {
+      char folded[256];
+
+      LetterTable()
+      {
+        std::fill(folded, folded + 256, '\0');
+        for (char c = 'a'; c <= 'z'; ++c)
+        {
+          folded[static_cast< unsigned char >(c)] = c;
+          folded[static_cast< unsigned char >(c - 'a' + 'A')] = c;
+        }
+      }
+    };
+
+    const LetterTable LETTERS;
   }
 
   std::vector< std::string > Tokenizer::tokenize(const std::string &input)
@@ -48,4 +66,53 @@ namespace crossref
     return tokens;
   }
 
+  void WordScanner::scan(const char *data, size_t size)
+  {
+    letters_.clear();
+    words_.clear();
+    letters_.reserve(size);
+
+    size_t start = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+      unsigned char c = static_cast< unsigned char >(data[i]);
+      if (c == ' ')
+      {
+        if (letters_.size() > start)
+        {
+          words_.emplace_back(start, letters_.size() - start);
+          start = letters_.size();
+        }
+      }
+      else if (LETTERS.folded[c] != '\0')
+      {
+        letters_.push_back(LETTERS.folded[c]);
+      }
+    }
+    if (letters_.size() > start)
+    {
+      words_.emplace_back(start, letters_.size() - start);
+    }
+  }
+
+  size_t WordScanner::count() const
+  {
+    return words_.size();
+  }
+
+  const char *WordScanner::word(size_t index) const
+  {
+    return letters_.data() + words_[index].first;
+  }
+
+  size_t WordScanner::length(size_t index) const
+  {
+    return words_[index].second;
+  }
+
+  std::string WordScanner::str(size_t index) const
+  {
+    return letters_.substr(words_[index].first, words_[index].second);
+  }
+
 }
@@ -6,6 +6,7 @@
 #include <cctype>
 #include <functional>
 #include <algorithm>
+#include <utility>
 
 namespace crossref
 {
@@ -16,6 +17,22 @@ namespace crossref
     static std::vector< std::string > tokenize(const std::string &input);
   };
 
+  // Splits a text line on spaces into words, keeping only ASCII letters folded to lower case.
+  // Buffers are reused from line to line.
+  class WordScanner
+  {
+  public:
+    void scan(const char *data, size_t size);
+    size_t count() const;
+    const char *word(size_t index) const;
+    size_t length(size_t index) const;
+    std::string str(size_t index) const;
+
+  private:
+    std::string letters_;
+    std::vector< std::pair< size_t, size_t > > words_;
+  };
+
 }
 
 #endif
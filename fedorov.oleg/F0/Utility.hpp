@@ -15,7 +15,6 @@ namespace crossref
   };
 
   std::istream &operator>>(std::istream &is, Line &l);
-  void splitRecursive(const std::string &s, size_t start, std::vector< std::string > &words);
 }
 
 #endif
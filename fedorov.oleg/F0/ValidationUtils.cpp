@@ -1,5 +1,6 @@
 #include "ValidationUtils.hpp"
 #include "HashTable.hpp"
+#include "LineSlice.hpp"
 
 namespace crossref
 {
@@ -51,7 +52,7 @@ namespace crossref
       }
     }
 
-    using checkerMapType = std::map< std::string, std::vector< std::string > >;
+    using checkerMapType = std::map< std::string, TextLines >;
     template void checkIdExists< checkerMapType >(const checkerMapType &, const std::string &, const std::string &);
     template void checkIdNotFound< checkerMapType >(const checkerMapType &, const std::string &, const std::string &);
 
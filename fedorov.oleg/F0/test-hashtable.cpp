@@ -0,0 +1,248 @@
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <list>
+#include <map>
+#include <numeric>
+#include <random>
+#include "HashTable.hpp"
+
+// crossref::HashTable against the quadratic-probing table it replaced. Run with
+// `make test-fedorov.oleg/F0 TEST_ARGS="--log_level=message -- <tokens> <vocabulary>"`
+// (50000 tokens over 5000 words by default; the old table is skipped above 200000 tokens).
+namespace
+{
+
+  using Clock = std::chrono::steady_clock;
+
+  // The former table: prime capacity, quadratic probing, a sorted std::list of lines per word.
+  class LegacyHashTable
+  {
+  public:
+    LegacyHashTable():
+      table(101),
+      itemCount(0)
+    {}
+
+    void insert(const std::string &key, int line)
+    {
+      if (itemCount >= table.size() * 0.75)
+      {
+        rehash();
+      }
+      Entry &entry = table[findPosition(key)];
+      if (!entry.isActive)
+      {
+        entry.word = key;
+        entry.isActive = true;
+        itemCount++;
+      }
+      if (std::find(entry.lines.begin(), entry.lines.end(), line) == entry.lines.end())
+      {
+        entry.lines.push_back(line);
+        entry.lines.sort();
+      }
+    }
+
+    std::vector< int > find(const std::string &key) const
+    {
+      const Entry &entry = table[findPosition(key)];
+      if (entry.isActive && entry.word == key)
+      {
+        return std::vector< int >(entry.lines.begin(), entry.lines.end());
+      }
+      return {};
+    }
+
+  private:
+    struct Entry
+    {
+      std::string word;
+      std::list< int > lines;
+      bool isActive;
+    };
+
+    std::vector< Entry > table;
+    size_t itemCount;
+
+    size_t findPosition(const std::string &key) const
+    {
+      size_t current = std::accumulate(key.begin(), key.end(), size_t(0), [](size_t h, unsigned char c)
+      {
+        return h * 31 + c;
+      }) % table.size();
+      for (size_t i = 1; i <= table.size(); ++i)
+      {
+        if (!table[current].isActive || table[current].word == key)
+        {
+          break;
+        }
+        current = (current + i * i) % table.size();
+      }
+      return current;
+    }
+
+    static bool isPrime(size_t n)
+    {
+      for (size_t i = 2; i * i <= n; ++i)
+      {
+        if (n % i == 0)
+        {
+          return false;
+        }
+      }
+      return n > 1;
+    }
+
+    void rehash()
+    {
+      std::vector< Entry > oldTable = std::move(table);
+      size_t size = oldTable.size() * 2 + 1;
+      while (!isPrime(size))
+      {
+        size += 2;
+      }
+      table = std::vector< Entry >(size);
+      itemCount = 0;
+      for (const Entry &entry: oldTable)
+      {
+        if (entry.isActive)
+        {
+          for (int line: entry.lines)
+          {
+            insert(entry.word, line);
+          }
+        }
+      }
+    }
+  };
+
+  size_t benchmarkArg(int index, size_t fallback)
+  {
+    const auto &suite = boost::unit_test::framework::master_test_suite();
+    return suite.argc > index ? std::stoul(suite.argv[index]) : fallback;
+  }
+
+  std::vector< std::string > vocabulary(size_t size)
+  {
+    std::vector< std::string > words;
+    words.reserve(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+      words.push_back("w" + std::to_string(i * 2654435761ULL % 1000000007ULL));
+    }
+    return words;
+  }
+
+  // Word ranks are log-uniform, which approximates the Zipf tail of natural text.
+  std::vector< uint32_t > tokenStream(size_t tokens, size_t vocabularySize)
+  {
+    std::mt19937 generator(17);
+    std::uniform_real_distribution< double > exponent(0.0, std::log(static_cast< double >(vocabularySize)));
+    std::vector< uint32_t > stream(tokens);
+    for (uint32_t &token: stream)
+    {
+      token = static_cast< uint32_t >(std::exp(exponent(generator))) - 1;
+      token = std::min(token, static_cast< uint32_t >(vocabularySize - 1));
+    }
+    return stream;
+  }
+
+  double secondsSince(Clock::time_point start)
+  {
+    return std::chrono::duration< double >(Clock::now() - start).count();
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(hash_table_matches_ordered_map)
+{
+  std::mt19937 generator(23);
+  std::uniform_int_distribution< int > word(0, 2999);
+  std::uniform_int_distribution< int > line(1, 500);
+  std::uniform_int_distribution< int > action(0, 9);
+  crossref::HashTable table;
+  std::map< std::string, std::vector< int > > reference;
+  for (int i = 0; i < 200000; ++i)
+  {
+    std::string key = "k" + std::to_string(word(generator));
+    if (action(generator) == 0)
+    {
+      table.remove(key);
+      reference.erase(key);
+      continue;
+    }
+    int value = line(generator);
+    table.insert(key, value);
+    std::vector< int > &lines = reference[key];
+    auto it = std::lower_bound(lines.begin(), lines.end(), value);
+    if (it == lines.end() || *it != value)
+    {
+      lines.insert(it, value);
+    }
+  }
+
+  BOOST_REQUIRE_EQUAL(table.size(), reference.size());
+  for (int i = 0; i < 3000; ++i)
+  {
+    std::string key = "k" + std::to_string(i);
+    auto it = reference.find(key);
+    BOOST_CHECK(table.find(key) == (it == reference.end() ? std::vector< int >() : it->second));
+  }
+  std::vector< std::pair< std::string, std::vector< int > > > expected(reference.begin(), reference.end());
+  BOOST_CHECK(table.getSortedEntries() == expected);
+}
+
+BOOST_AUTO_TEST_CASE(hash_table_benchmark)
+{
+  size_t tokens = benchmarkArg(1, 50000);
+  size_t vocabularySize = std::max< size_t >(benchmarkArg(2, 5000), 1);
+  std::vector< std::string > words = vocabulary(vocabularySize);
+  std::vector< uint32_t > stream = tokenStream(tokens, vocabularySize);
+
+  auto start = Clock::now();
+  crossref::HashTable table;
+  for (size_t i = 0; i < stream.size(); ++i)
+  {
+    table.insert(words[stream[i]], static_cast< int >(i / 10 + 1));
+  }
+  double insertTime = secondsSince(start);
+  BOOST_CHECK_LE(table.size(), vocabularySize);
+
+  start = Clock::now();
+  size_t found = 0;
+  for (const std::string &word: words)
+  {
+    found += table.find(word).size();
+  }
+  double findTime = secondsSince(start);
+  BOOST_TEST_MESSAGE(tokens << " tokens, " << table.size() << " words: HashTable insert " << insertTime
+      << " s (" << tokens / std::max(insertTime, 1e-9) / 1e6 << " Mtok/s), " << words.size() << " finds "
+      << findTime << " s");
+
+  if (tokens > 200000)
+  {
+    return;
+  }
+  start = Clock::now();
+  LegacyHashTable legacy;
+  for (size_t i = 0; i < stream.size(); ++i)
+  {
+    legacy.insert(words[stream[i]], static_cast< int >(i / 10 + 1));
+  }
+  double legacyInsertTime = secondsSince(start);
+
+  start = Clock::now();
+  size_t legacyFound = 0;
+  for (const std::string &word: words)
+  {
+    std::vector< int > lines = legacy.find(word);
+    legacyFound += lines.size();
+    BOOST_CHECK(lines == table.find(word));
+  }
+  double legacyFindTime = secondsSince(start);
+  BOOST_CHECK_EQUAL(found, legacyFound);
+  BOOST_TEST_MESSAGE("legacy table insert " << legacyInsertTime << " s, " << words.size() << " finds "
+      << legacyFindTime << " s (includes the comparison)");
+}
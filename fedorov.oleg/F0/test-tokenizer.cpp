@@ -0,0 +1,148 @@
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <random>
+#include "Tokenizer.hpp"
+
+// WordScanner throughput against the former split-then-sanitize path. Run with
+// `make test-fedorov.oleg/F0 TEST_ARGS="--log_level=message -- <megabytes>"` (16 MB by default).
+namespace
+{
+
+  using Clock = std::chrono::steady_clock;
+
+  void splitRecursive(const std::string &s, size_t start, std::vector< std::string > &words)
+  {
+    size_t end = s.find(' ', start);
+    if (end == std::string::npos)
+    {
+      if (start < s.size())
+      {
+        words.push_back(s.substr(start));
+      }
+      return;
+    }
+    if (end > start)
+    {
+      words.push_back(s.substr(start, end - start));
+    }
+    splitRecursive(s, end + 1, words);
+  }
+
+  std::string sanitizeWord(std::string word)
+  {
+    word.erase(std::remove_if(word.begin(), word.end(), [](unsigned char c)
+    {
+      return !std::isalpha(c);
+    }), word.end());
+    std::transform(word.begin(), word.end(), word.begin(), [](unsigned char c)
+    {
+      return static_cast< char >(std::tolower(c));
+    });
+    return word;
+  }
+
+  std::vector< std::string > referenceWords(const std::string &line)
+  {
+    std::vector< std::string > words;
+    splitRecursive(line, 0, words);
+    std::vector< std::string > cleanWords;
+    for (const std::string &word: words)
+    {
+      std::string clean = sanitizeWord(word);
+      if (!clean.empty())
+      {
+        cleanWords.push_back(clean);
+      }
+    }
+    return cleanWords;
+  }
+
+  std::vector< std::string > textLines(size_t bytes)
+  {
+    const char *alphabet = "etaoinshrdlucmfwyp ETAOIN  ,.;'-!?0123456789\t";
+    size_t alphabetSize = std::char_traits< char >::length(alphabet);
+    std::mt19937 generator(29);
+    std::uniform_int_distribution< size_t > symbol(0, alphabetSize - 1);
+    std::uniform_int_distribution< size_t > lineLength(0, 120);
+    std::vector< std::string > lines;
+    for (size_t total = 0; total < bytes;)
+    {
+      std::string line(lineLength(generator), ' ');
+      for (char &c: line)
+      {
+        c = alphabet[symbol(generator)];
+      }
+      total += line.size() + 1;
+      lines.push_back(std::move(line));
+    }
+    return lines;
+  }
+
+  size_t benchmarkMegabytes()
+  {
+    const auto &suite = boost::unit_test::framework::master_test_suite();
+    return suite.argc > 1 ? std::stoul(suite.argv[1]) : 16;
+  }
+
+  double secondsSince(Clock::time_point start)
+  {
+    return std::chrono::duration< double >(Clock::now() - start).count();
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(word_scanner_matches_reference)
+{
+  std::vector< std::string > lines = textLines(1 << 20);
+  lines.push_back("");
+  lines.push_back("   ");
+  lines.push_back("--- Hello,  WORLD's\tend ");
+  crossref::WordScanner scanner;
+  for (const std::string &line: lines)
+  {
+    scanner.scan(line.data(), line.size());
+    std::vector< std::string > words;
+    for (size_t i = 0; i < scanner.count(); ++i)
+    {
+      words.push_back(scanner.str(i));
+      BOOST_CHECK_EQUAL(std::string(scanner.word(i), scanner.length(i)), words.back());
+    }
+    BOOST_CHECK(words == referenceWords(line));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(word_scanner_throughput)
+{
+  std::vector< std::string > lines = textLines(benchmarkMegabytes() << 20);
+  size_t bytes = 0;
+  for (const std::string &line: lines)
+  {
+    bytes += line.size() + 1;
+  }
+
+  auto start = Clock::now();
+  size_t referenceTokens = 0;
+  for (const std::string &line: lines)
+  {
+    referenceTokens += referenceWords(line).size();
+  }
+  double referenceTime = secondsSince(start);
+
+  start = Clock::now();
+  crossref::WordScanner scanner;
+  size_t tokens = 0;
+  for (const std::string &line: lines)
+  {
+    scanner.scan(line.data(), line.size());
+    tokens += scanner.count();
+  }
+  double scannerTime = secondsSince(start);
+
+  BOOST_CHECK_EQUAL(tokens, referenceTokens);
+  BOOST_TEST_MESSAGE(bytes << " bytes, " << tokens << " tokens: WordScanner "
+      << tokens / std::max(scannerTime, 1e-9) / 1e6 << " Mtok/s (" << bytes / std::max(scannerTime, 1e-9) / 1e6
+      << " MB/s), split and sanitize " << referenceTokens / std::max(referenceTime, 1e-9) / 1e6 << " Mtok/s ("
+      << bytes / std::max(referenceTime, 1e-9) / 1e6 << " MB/s)");
+}
@@ -1,5 +1,6 @@
 #include "CommandProcessor.hpp"
 #include <algorithm>
+#include <chrono>
 #include <iomanip>
 #include <iterator>
 #include <limits>
@@ -51,6 +52,8 @@ gavrilova::CommandProcessor::CommandProcessor(StudentDatabase& db):
   commandMap_["create_group"] = std::bind(&CommandProcessor::handleCreateGroup, this);
   commandMap_["save"] = std::bind(&CommandProcessor::handleSave, this);
   commandMap_["loadbase"] = std::bind(&CommandProcessor::handleLoad, this);
+  commandMap_["savesnapshot"] = std::bind(&CommandProcessor::handleSaveSnapshot, this);
+  commandMap_["loadsnapshot"] = std::bind(&CommandProcessor::handleLoadSnapshot, this);
 }
 
 void gavrilova::CommandProcessor::run()
@@ -92,6 +95,8 @@ void gavrilova::CommandProcessor::handleHelp()
                "create_group <группа>\n"
                "save <файл>\n"
                "loadbase <файл>\n"
+               "savesnapshot <файл>\n"
+               "loadsnapshot <файл>\n"
                "clear\n";
 }
 
@@ -257,10 +262,20 @@ void gavrilova::CommandProcessor::handleLoadGrades()
     std::cin.clear();
     return;
   }
-  if (db_.loadGradesFromFile(groupName, date, filename)) {
-    std::cout << "Оценки для группы " << groupName << " из файла " << filename << " загружены.\n";
-  } else {
+  auto start = std::chrono::steady_clock::now();
+  auto result = db_.loadGradesBatched(groupName, date, filename);
+  std::chrono::duration< double > elapsed = std::chrono::steady_clock::now() - start;
+  if (!result.first) {
     std::cout << "<INVALID COMMAND>\n";
+    return;
+  }
+  const GradeLoadReport& report = result.second;
+  size_t rows = report.accepted + report.rejected;
+  std::cout << "Оценки для группы " << groupName << " из файла " << filename << " загружены.\n";
+  std::cout << " - Принято строк: " << report.accepted << '\n';
+  std::cout << " - Отклонено строк: " << report.rejected << '\n';
+  if (elapsed.count() > 0.0) {
+    std::cout << " - Скорость: " << static_cast< unsigned long long >(rows / elapsed.count()) << " строк/с\n";
   }
 }
 
@@ -363,3 +378,25 @@ void gavrilova::CommandProcessor::handleLoad()
     std::cout << "Ошибка загрузки файла.\n";
   }
 }
+
+void gavrilova::CommandProcessor::handleSaveSnapshot()
+{
+  std::string filename;
+  std::cin >> filename;
+  if (db_.saveSnapshot(filename)) {
+    std::cout << "Снимок базы данных сохранен в файл " << filename << '\n';
+  } else {
+    std::cout << "Ошибка сохранения файла.\n";
+  }
+}
+
+void gavrilova::CommandProcessor::handleLoadSnapshot()
+{
+  std::string filename;
+  std::cin >> filename;
+  if (db_.loadSnapshot(filename)) {
+    std::cout << "Снимок базы данных загружен из файла " << filename << '\n';
+  } else {
+    std::cout << "Ошибка загрузки файла.\n";
+  }
+}
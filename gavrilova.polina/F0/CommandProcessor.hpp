@@ -40,6 +40,8 @@ namespace gavrilova {
     void handleCreateGroup();
     void handleSave();
     void handleLoad();
+    void handleSaveSnapshot();
+    void handleLoadSnapshot();
   };
 
 }
@@ -0,0 +1,138 @@
+#include "Snapshot.hpp"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+  template < typename T >
+  void putLittleEndian(std::vector< char >& out, T value)
+  {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+      out.push_back(static_cast< char >((value >> (8 * i)) & 0xFF));
+    }
+  }
+
+  template < typename T >
+  T getLittleEndian(const unsigned char* in)
+  {
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+      value |= static_cast< T >(in[i]) << (8 * i);
+    }
+    return value;
+  }
+}
+
+void gavrilova::snapshot::Writer::putU32(uint32_t value)
+{
+  putLittleEndian(buffer_, value);
+}
+
+void gavrilova::snapshot::Writer::putU64(uint64_t value)
+{
+  putLittleEndian(buffer_, value);
+}
+
+void gavrilova::snapshot::Writer::putI32(int32_t value)
+{
+  putLittleEndian(buffer_, static_cast< uint32_t >(value));
+}
+
+void gavrilova::snapshot::Writer::putString(const std::string& value)
+{
+  putU32(static_cast< uint32_t >(value.size()));
+  buffer_.insert(buffer_.end(), value.begin(), value.end());
+}
+
+void gavrilova::snapshot::Writer::putHeader()
+{
+  buffer_.insert(buffer_.end(), MAGIC, MAGIC + sizeof(MAGIC));
+  putU32(VERSION);
+}
+
+bool gavrilova::snapshot::Writer::writeTo(const std::string& filename) const
+{
+  std::ofstream out(filename, std::ios::binary);
+  if (!out) {
+    return false;
+  }
+  out.write(buffer_.data(), buffer_.size());
+  return static_cast< bool >(out);
+}
+
+gavrilova::snapshot::Reader::Reader(std::vector< char > buffer):
+  buffer_(std::move(buffer)),
+  pos_(0)
+{}
+
+const unsigned char* gavrilova::snapshot::Reader::take(size_t count)
+{
+  if (buffer_.size() - pos_ < count) {
+    throw std::runtime_error("Truncated snapshot");
+  }
+  const unsigned char* data = reinterpret_cast< const unsigned char* >(buffer_.data() + pos_);
+  pos_ += count;
+  return data;
+}
+
+uint32_t gavrilova::snapshot::Reader::getU32()
+{
+  return getLittleEndian< uint32_t >(take(sizeof(uint32_t)));
+}
+
+uint64_t gavrilova::snapshot::Reader::getU64()
+{
+  return getLittleEndian< uint64_t >(take(sizeof(uint64_t)));
+}
+
+int32_t gavrilova::snapshot::Reader::getI32()
+{
+  return static_cast< int32_t >(getU32());
+}
+
+std::string gavrilova::snapshot::Reader::getString()
+{
+  uint32_t size = getU32();
+  const unsigned char* data = take(size);
+  return std::string(reinterpret_cast< const char* >(data), size);
+}
+
+bool gavrilova::snapshot::Reader::checkHeader()
+{
+  const unsigned char* magic = take(sizeof(MAGIC));
+  if (!std::equal(MAGIC, MAGIC + sizeof(MAGIC), reinterpret_cast< const char* >(magic))) {
+    return false;
+  }
+  return getU32() == VERSION;
+}
+
+bool gavrilova::snapshot::Reader::atEnd() const
+{
+  return pos_ == buffer_.size();
+}
+
+bool gavrilova::snapshot::readFile(const std::string& filename, std::vector< char >& buffer)
+{
+  std::ifstream in(filename, std::ios::binary | std::ios::ate);
+  if (!in) {
+    return false;
+  }
+  std::streamsize size = in.tellg();
+  if (size < 0) {
+    return false;
+  }
+  in.seekg(0);
+  buffer.resize(static_cast< size_t >(size));
+  return static_cast< bool >(in.read(buffer.data(), size));
+}
+
+bool gavrilova::snapshot::hasMagic(const std::string& filename)
+{
+  std::ifstream in(filename, std::ios::binary);
+  char magic[sizeof(MAGIC)] = {};
+  if (!in.read(magic, sizeof(magic))) {
+    return false;
+  }
+  return std::equal(MAGIC, MAGIC + sizeof(MAGIC), magic);
+}
@@ -0,0 +1,49 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gavrilova {
+  namespace snapshot {
+    // Формат: "GVDB", версия, затем поля фиксированной ширины в little-endian.
+    constexpr char MAGIC[4] = {'G', 'V', 'D', 'B'};
+    constexpr uint32_t VERSION = 1;
+
+    class Writer {
+    public:
+      void putU32(uint32_t value);
+      void putU64(uint64_t value);
+      void putI32(int32_t value);
+      void putString(const std::string& value);
+      void putHeader();
+      bool writeTo(const std::string& filename) const;
+
+    private:
+      std::vector< char > buffer_;
+    };
+
+    class Reader {
+    public:
+      explicit Reader(std::vector< char > buffer);
+      uint32_t getU32();
+      uint64_t getU64();
+      int32_t getI32();
+      std::string getString();
+      bool checkHeader();
+      bool atEnd() const;
+
+    private:
+      std::vector< char > buffer_;
+      size_t pos_;
+
+      const unsigned char* take(size_t count);
+    };
+
+    bool readFile(const std::string& filename, std::vector< char >& buffer);
+    bool hasMagic(const std::string& filename);
+  }
+}
+
+#endif
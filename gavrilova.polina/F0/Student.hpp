@@ -16,12 +16,14 @@ namespace gavrilova {
       std::string fullName_;
       std::string group_;
       std::map< gavrilova::date::Date, int > grades_;
+      long long gradeSum_;
       double averageGrade_;
 
       Student():
         id_(0),
         fullName_(""),
         group_(""),
+        gradeSum_(0),
         averageGrade_(0.0)
       {}
 
@@ -30,6 +32,7 @@ namespace gavrilova {
         fullName_(fullName),
         group_(group),
         grades_(),
+        gradeSum_(0),
         averageGrade_(0.0)
       {}
     };
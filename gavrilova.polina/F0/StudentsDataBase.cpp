@@ -1,10 +1,13 @@
 #include "StudentsDataBase.hpp"
 #include <algorithm>
+#include <cctype>
 #include <cmath>
 #include <fstream>
 #include <iterator>
+#include <limits>
 #include <numeric>
 #include <stdexcept>
+#include "Snapshot.hpp"
 
 namespace {
 
@@ -38,6 +41,14 @@ namespace {
     }
   };
 
+  struct CompareStudentsById {
+    bool operator()(const std::shared_ptr< const gavrilova::student::Student >& a,
+        const std::shared_ptr< const gavrilova::student::Student >& b) const
+    {
+      return a->id_ < b->id_;
+    }
+  };
+
   struct IsGradeInPeriod {
     const gavrilova::DateRange& period;
     bool operator()(const std::pair< gavrilova::date::Date, int >& grade) const
@@ -112,15 +123,6 @@ namespace {
     }
   };
 
-  struct IsRiskStudentPredicate {
-    double threshold;
-    bool operator()(const std::pair< gavrilova::StudentID,
-        std::shared_ptr< gavrilova::student::Student > >& p) const
-    {
-      return !p.second->grades_.empty() && p.second->averageGrade_ < threshold;
-    }
-  };
-
   struct IsRiskStudentInGroupPredicate {
     double threshold;
     bool operator()(const std::shared_ptr< const gavrilova::student::Student >& s) const
@@ -129,13 +131,6 @@ namespace {
     }
   };
 
-  struct GradePairAccumulator {
-    double operator()(double sum, const std::pair< gavrilova::StudentID, int >& p) const
-    {
-      return sum + p.second;
-    }
-  };
-
   struct StudentAdder {
     gavrilova::StudentDatabase& db;
 
@@ -148,10 +143,8 @@ namespace {
       bool ok = pair.first;
       gavrilova::StudentID id = pair.second;
       if (ok) {
-        auto sp = db.findStudentById(id);
-        if (sp) {
-          sp->grades_ = stud.grades_;
-          db.updateStudentAverageGrade(sp);
+        for (const auto& grade: stud.grades_) {
+          db.addGrade(id, grade.second, grade.first);
         }
       }
     }
@@ -166,27 +159,99 @@ namespace {
     }
   };
 
-  struct GradeFileLineProcessor {
-    gavrilova::StudentDatabase& db;
-    const std::string& groupName;
-    const gavrilova::date::Date& date;
-    mutable gavrilova::StudentID currentId = 0;
+  const size_t GRADE_CHUNK_SIZE = 1 << 20;
+  const size_t GRADE_BATCH_SIZE = 1 << 16;
 
-    void operator()(const std::string& line) const
+  bool isBlank(char c)
+  {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+  }
+
+  bool startsWith(const char* begin, const char* end, const std::string& prefix)
+  {
+    return static_cast< size_t >(end - begin) >= prefix.size() && std::equal(prefix.begin(), prefix.end(), begin);
+  }
+
+  bool parseNumber(const char* it, const char* end, long long& value)
+  {
+    bool negative = it != end && *it == '-';
+    if (it != end && (*it == '-' || *it == '+')) {
+      ++it;
+    }
+    if (it == end || !std::isdigit(static_cast< unsigned char >(*it))) {
+      return false;
+    }
+    value = 0;
+    for (; it != end && std::isdigit(static_cast< unsigned char >(*it)); ++it) {
+      if (value >= 1000000000000LL) {
+        return false;
+      }
+      value = value * 10 + (*it - '0');
+    }
+    value = negative ? -value : value;
+    return true;
+  }
+
+  struct GradeRowParser {
+    std::vector< std::pair< gavrilova::StudentID, int > >& rows;
+    gavrilova::GradeLoadReport& report;
+    gavrilova::StudentID currentId = 0;
+    std::string carry;
+
+    void feed(const char* begin, const char* end)
     {
-      if (line.find("ID:") == 0) {
-        currentId = std::stoul(line.substr(3));
-      } else if (line.find("Оценка:") == 0 && currentId) {
-        std::string value = line.substr(13);
-        value.erase(0, value.find_first_not_of(' '));
-        if (!value.empty() && std::any_of(value.begin(), value.end(), ::isdigit)) {
-          int grade = std::stoi(value);
-          db.addGrade(currentId, grade, date);
+      const char* it = begin;
+      while (it != end) {
+        const char* tokenEnd = std::find_if(it, end, isBlank);
+        if (tokenEnd == end) {
+          carry.append(it, end);
+          return;
+        }
+        if (carry.empty()) {
+          handleToken(it, tokenEnd);
+        } else {
+          carry.append(it, tokenEnd);
+          flush();
+        }
+        it = std::find_if_not(tokenEnd, end, isBlank);
+      }
+    }
+
+    void flush()
+    {
+      if (!carry.empty()) {
+        handleToken(carry.data(), carry.data() + carry.size());
+        carry.clear();
+      }
+    }
+
+    void handleToken(const char* begin, const char* end)
+    {
+      static const std::string idPrefix = "ID:";
+      static const std::string gradePrefix = "Оценка:";
+      long long value = 0;
+      if (startsWith(begin, end, idPrefix)) {
+        currentId = parseNumber(begin + idPrefix.size(), end, value) && value > 0 ? value : 0;
+      } else if (startsWith(begin, end, gradePrefix) && begin + gradePrefix.size() != end) {
+        bool valid = currentId && parseNumber(begin + gradePrefix.size(), end, value)
+            && value >= std::numeric_limits< int >::min() && value <= std::numeric_limits< int >::max();
+        if (valid) {
+          rows.emplace_back(currentId, static_cast< int >(value));
+        } else {
+          ++report.rejected;
         }
       }
     }
   };
 
+  struct CompareRowsById {
+    bool operator()(const std::pair< gavrilova::StudentID, int >& a,
+        const std::pair< gavrilova::StudentID, int >& b) const
+    {
+      return a.first < b.first;
+    }
+  };
+
   struct GroupStudentExporter {
     std::ostream& out;
 
@@ -201,6 +266,14 @@ namespace {
   };
 }
 
+bool gavrilova::StudentDatabase::RankOrder::operator()(const RankKey& a, const RankKey& b) const
+{
+  if (a.average == b.average) {
+    return a.id < b.id;
+  }
+  return a.average > b.average;
+}
+
 gavrilova::StudentDatabase::StudentDatabase(int id_digits)
 {
   nextId = std::pow(10, id_digits - 1) + 1;
@@ -219,6 +292,9 @@ bool gavrilova::StudentDatabase::saveToFile(const std::string& filename) const
 
 bool gavrilova::StudentDatabase::loadFromFile(const std::string& filename)
 {
+  if (snapshot::hasMagic(filename)) {
+    return loadSnapshot(filename);
+  }
   std::ifstream in(filename);
   if (!in) {
     return false;
@@ -232,12 +308,119 @@ bool gavrilova::StudentDatabase::loadFromFile(const std::string& filename)
   return true;
 }
 
+bool gavrilova::StudentDatabase::saveSnapshot(const std::string& filename) const
+{
+  snapshot::Writer writer;
+  writer.putHeader();
+  writer.putU64(nextId);
+
+  std::map< std::string, uint32_t > groupIndex;
+  writer.putU32(static_cast< uint32_t >(groups.size()));
+  for (const auto& group: groups) {
+    groupIndex.emplace_hint(groupIndex.end(), group.first, static_cast< uint32_t >(groupIndex.size()));
+    writer.putString(group.first);
+  }
+
+  writer.putU64(students.size());
+  for (const auto& entry: students) {
+    const student::Student& stud = *entry.second;
+    writer.putU64(stud.id_);
+    writer.putU32(groupIndex.at(stud.group_));
+    writer.putString(stud.fullName_);
+    writer.putU32(static_cast< uint32_t >(stud.grades_.size()));
+    for (const auto& grade: stud.grades_) {
+      writer.putI32(grade.first.year);
+      writer.putI32(grade.first.month);
+      writer.putI32(grade.first.day);
+      writer.putI32(grade.second);
+    }
+  }
+
+  return writer.writeTo(filename);
+}
+
+bool gavrilova::StudentDatabase::loadSnapshot(const std::string& filename)
+{
+  std::vector< char > buffer;
+  if (!snapshot::readFile(filename, buffer)) {
+    return false;
+  }
+
+  std::map< StudentID, std::shared_ptr< student::Student > > newStudents;
+  std::map< std::string, Group > newGroups;
+  std::map< std::string, std::set< StudentID > > newNameIndex;
+  std::map< date::Date, DateAggregate > newDateAggregates;
+  std::set< RankKey, RankOrder > newRankIndex;
+  StudentID newNextId = 0;
+
+  try {
+    snapshot::Reader reader(std::move(buffer));
+    if (!reader.checkHeader()) {
+      return false;
+    }
+    newNextId = reader.getU64();
+
+    std::vector< std::map< std::string, Group >::iterator > groupSlots;
+    uint32_t groupCount = reader.getU32();
+    for (uint32_t i = 0; i < groupCount; ++i) {
+      groupSlots.push_back(newGroups.emplace_hint(newGroups.end(), reader.getString(), Group{}));
+    }
+
+    uint64_t studentCount = reader.getU64();
+    for (uint64_t i = 0; i < studentCount; ++i) {
+      StudentID id = reader.getU64();
+      uint32_t groupSlot = reader.getU32();
+      if (newStudents.count(id) || groupSlot >= groupSlots.size()) {
+        return false;
+      }
+      auto groupIt = groupSlots[groupSlot];
+      auto stud = std::make_shared< student::Student >(id, reader.getString(), groupIt->first);
+
+      uint32_t gradeCount = reader.getU32();
+      for (uint32_t j = 0; j < gradeCount; ++j) {
+        date::Date date;
+        date.year = reader.getI32();
+        date.month = reader.getI32();
+        date.day = reader.getI32();
+        int grade = reader.getI32();
+        stud->grades_.emplace_hint(stud->grades_.end(), date, grade);
+        DateAggregate& aggregate = newDateAggregates[date];
+        aggregate.sum += grade;
+        ++aggregate.count;
+        stud->gradeSum_ += grade;
+      }
+      if (gradeCount) {
+        stud->averageGrade_ = static_cast< double >(stud->gradeSum_) / gradeCount;
+      }
+      newRankIndex.insert(RankKey{stud->averageGrade_, id});
+
+      newStudents.emplace_hint(newStudents.end(), id, stud);
+      groupIt->second.emplace_hint(groupIt->second.end(), id, stud);
+      newNameIndex[stud->fullName_].insert(id);
+    }
+    if (!reader.atEnd()) {
+      return false;
+    }
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+
+  students.swap(newStudents);
+  groups.swap(newGroups);
+  nameToStudentIndex.swap(newNameIndex);
+  dateAggregates.swap(newDateAggregates);
+  rankIndex.swap(newRankIndex);
+  nextId = newNextId;
+  return true;
+}
+
 void gavrilova::StudentDatabase::clear()
 {
   students.clear();
   groups.clear();
   nameToStudentIndex.clear();
-  dateToGradesIndex.clear();
+  dateAggregates.clear();
+  rankIndex.clear();
 }
 
 bool gavrilova::StudentDatabase::createGroup(const std::string& groupName)
@@ -279,6 +462,7 @@ std::pair< bool, gavrilova::StudentID > gavrilova::StudentDatabase::addStudent
   students[nextId] = student;
   groups[groupName][nextId] = student;
   nameToStudentIndex[fullName].insert(nextId);
+  rankIndex.insert(RankKey{student->averageGrade_, nextId});
 
   return {true, nextId++};
 }
@@ -291,34 +475,10 @@ bool gavrilova::StudentDatabase::deleteStudent(StudentID id)
   }
   const auto& student = it_student->second;
 
-  struct GradeRemoverFromDateIndex {
-    struct IsStudentGrade {
-      StudentID studentId;
-      bool operator()(const std::pair< StudentID, int >& p) const
-      {
-        return p.first == studentId;
-      }
-    };
-    StudentID studentIdToRemove;
-    std::map< date::Date, std::vector< std::pair< StudentID, int > > >* dateIndex;
-
-    void operator()(const std::pair< const date::Date, int >& gradeEntry)
-    {
-      auto it_date = dateIndex->find(gradeEntry.first);
-      if (it_date != dateIndex->end()) {
-        auto& gradesOnDate = it_date->second;
-        auto newEnd = std::remove_if(gradesOnDate.begin(), gradesOnDate.end(), IsStudentGrade{studentIdToRemove});
-        gradesOnDate.erase(newEnd, gradesOnDate.end());
-
-        if (gradesOnDate.empty()) {
-          dateIndex->erase(it_date);
-        }
-      }
-    }
-  };
-
-  std::for_each(student->grades_.begin(), student->grades_.end(),
-      GradeRemoverFromDateIndex{id, &dateToGradesIndex});
+  for (const auto& grade: student->grades_) {
+    removeFromDateAggregate(grade.first, grade.second);
+  }
+  rankIndex.erase(RankKey{student->averageGrade_, id});
 
   groups.at(student->group_).erase(id);
 
@@ -378,8 +538,8 @@ bool gavrilova::StudentDatabase::addGrade(StudentID id, int grade, const date::D
   }
 
   student_ptr->grades_[date] = grade;
-  dateToGradesIndex[date].push_back({id, grade});
-  updateStudentAverageGrade(student_ptr);
+  addToDateAggregate(date, grade);
+  applyGradeDelta(*student_ptr, grade);
 
   return true;
 }
@@ -391,31 +551,13 @@ bool gavrilova::StudentDatabase::changeGrade(StudentID id, int newGrade, const d
   if (!student_ptr || !student_ptr->grades_.count(date)) {
     return false;
   }
-  student_ptr->grades_[date] = newGrade;
+  int& grade = student_ptr->grades_[date];
+  int oldGrade = grade;
+  grade = newGrade;
 
-  struct GradeChanger {
-    int newGrade;
-    void operator()(std::pair< StudentID, int >& p) const
-    {
-      p.second = newGrade;
-    }
-  };
-
-  struct FindGradePredicate {
-    StudentID studentId;
-    bool operator()(const std::pair< StudentID, int >& p) const
-    {
-      return p.first == studentId;
-    }
-  };
-
-  auto& grades_on_date = dateToGradesIndex.at(date);
-  auto it_grade = std::find_if(grades_on_date.begin(), grades_on_date.end(), FindGradePredicate{id});
-  if (it_grade != grades_on_date.end()) {
-    GradeChanger{newGrade}(*it_grade);
-  }
-
-  updateStudentAverageGrade(student_ptr);
+  removeFromDateAggregate(date, oldGrade);
+  addToDateAggregate(date, newGrade);
+  applyGradeDelta(*student_ptr, static_cast< long long >(newGrade) - oldGrade);
   return true;
 }
 
@@ -425,42 +567,53 @@ bool gavrilova::StudentDatabase::removeGradesByDate(StudentID id, const date::Da
   if (!student_ptr || !student_ptr->grades_.count(date)) {
     return false;
   }
-  student_ptr->grades_.erase(date);
+  auto it_grade = student_ptr->grades_.find(date);
+  int oldGrade = it_grade->second;
+  student_ptr->grades_.erase(it_grade);
 
-  struct IsStudentGrade {
-    StudentID studentId;
-    bool operator()(const std::pair< StudentID, int >& p) const
-    {
-      return p.first == studentId;
-    }
-  };
+  removeFromDateAggregate(date, oldGrade);
+  applyGradeDelta(*student_ptr, -oldGrade);
+  return true;
+}
 
-  auto it_date = dateToGradesIndex.find(date);
-  if (it_date != dateToGradesIndex.end()) {
-    auto& grades_on_date = it_date->second;
-    auto new_end = std::remove_if(grades_on_date.begin(), grades_on_date.end(), IsStudentGrade{id});
-    grades_on_date.erase(new_end, grades_on_date.end());
-    if (grades_on_date.empty()) {
-      dateToGradesIndex.erase(it_date);
-    }
+void gavrilova::StudentDatabase::updateStudentAverageGrade(std::shared_ptr< student::Student >& student)
+{
+  long long sum = 0;
+  for (const auto& grade: student->grades_) {
+    sum += grade.second;
   }
+  applyGradeDelta(*student, sum - student->gradeSum_);
+}
 
-  updateStudentAverageGrade(student_ptr);
-  return true;
+void gavrilova::StudentDatabase::applyGradeDelta(student::Student& student, long long sumDelta)
+{
+  rankIndex.erase(RankKey{student.averageGrade_, student.id_});
+  student.gradeSum_ += sumDelta;
+  if (student.grades_.empty()) {
+    student.averageGrade_ = 0.0;
+  } else {
+    student.averageGrade_ = static_cast< double >(student.gradeSum_) / student.grades_.size();
+  }
+  rankIndex.insert(RankKey{student.averageGrade_, student.id_});
 }
 
-void gavrilova::StudentDatabase::updateStudentAverageGrade(std::shared_ptr< student::Student >& student)
+void gavrilova::StudentDatabase::addToDateAggregate(const date::Date& date, int grade)
 {
-  if (student->grades_.empty()) {
-    student->averageGrade_ = 0.0;
+  DateAggregate& aggregate = dateAggregates[date];
+  aggregate.sum += grade;
+  ++aggregate.count;
+}
+
+void gavrilova::StudentDatabase::removeFromDateAggregate(const date::Date& date, int grade)
+{
+  auto it = dateAggregates.find(date);
+  if (it == dateAggregates.end()) {
     return;
   }
-
-  double sum = 0.0;
-  for (const auto& grade: student->grades_) {
-    sum += grade.second;
+  it->second.sum -= grade;
+  if (--it->second.count == 0) {
+    dateAggregates.erase(it);
   }
-  student->averageGrade_ = sum / student->grades_.size();
 }
 
 std::vector< std::shared_ptr< const gavrilova::student::Student > >
@@ -501,20 +654,92 @@ bool gavrilova::StudentDatabase::exportGroupForGrading
 bool gavrilova::StudentDatabase::loadGradesFromFile(const std::string& groupName,
     const date::Date& date, const std::string& filename)
 {
+  return loadGradesBatched(groupName, date, filename).first;
+}
+
+std::pair< bool, gavrilova::GradeLoadReport > gavrilova::StudentDatabase::loadGradesBatched
+    (const std::string& groupName, const date::Date& date, const std::string& filename)
+{
+  GradeLoadReport report;
   if (!groupExists(groupName)) {
-    return false;
+    return {false, report};
   }
 
-  std::ifstream in(filename);
+  std::ifstream in(filename, std::ios::binary);
   if (!in) {
-    return false;
+    return {false, report};
   }
-  std::vector< std::string > lines((std::istream_iterator< std::string >(in)),
-      std::istream_iterator< std::string >());
 
-  std::for_each(lines.begin(), lines.end(), GradeFileLineProcessor{*this, groupName, date});
+  std::vector< char > chunk(GRADE_CHUNK_SIZE);
+  std::vector< std::pair< StudentID, int > > rows;
+  rows.reserve(GRADE_BATCH_SIZE);
+  std::vector< RankKey > staleKeys;
+  GradeRowParser parser{rows, report, 0, std::string()};
+  while (in) {
+    in.read(chunk.data(), chunk.size());
+    parser.feed(chunk.data(), chunk.data() + in.gcount());
+    if (rows.size() >= GRADE_BATCH_SIZE) {
+      applyGradeBatch(rows, date, report, staleKeys);
+    }
+  }
+  parser.flush();
+  applyGradeBatch(rows, date, report, staleKeys);
+  refreshRankIndex(staleKeys);
 
-  return true;
+  return {true, report};
+}
+
+void gavrilova::StudentDatabase::applyGradeBatch(std::vector< std::pair< StudentID, int > >& rows,
+    const date::Date& date, GradeLoadReport& report, std::vector< RankKey >& staleKeys)
+{
+  std::stable_sort(rows.begin(), rows.end(), CompareRowsById{});
+
+  DateAggregate added;
+  auto it = rows.begin();
+  while (it != rows.end()) {
+    auto last = std::upper_bound(it, rows.end(), *it, CompareRowsById{});
+    auto it_student = students.find(it->first);
+    if (it_student == students.end() || it_student->second->grades_.count(date)) {
+      report.rejected += last - it;
+    } else {
+      student::Student& student = *it_student->second;
+      staleKeys.push_back(RankKey{student.averageGrade_, student.id_});
+      student.grades_.emplace(date, it->second);
+      student.gradeSum_ += it->second;
+      student.averageGrade_ = static_cast< double >(student.gradeSum_) / student.grades_.size();
+      added.sum += it->second;
+      ++added.count;
+      ++report.accepted;
+      report.rejected += last - it - 1;
+    }
+    it = last;
+  }
+
+  if (added.count) {
+    DateAggregate& aggregate = dateAggregates[date];
+    aggregate.sum += added.sum;
+    aggregate.count += added.count;
+  }
+  rows.clear();
+}
+
+void gavrilova::StudentDatabase::refreshRankIndex(const std::vector< RankKey >& staleKeys)
+{
+  if (staleKeys.size() < rankIndex.size() / 8) {
+    for (const RankKey& key: staleKeys) {
+      rankIndex.erase(key);
+      rankIndex.insert(RankKey{students.at(key.id)->averageGrade_, key.id});
+    }
+    return;
+  }
+
+  std::vector< RankKey > keys;
+  keys.reserve(students.size());
+  for (const auto& entry: students) {
+    keys.push_back(RankKey{entry.second->averageGrade_, entry.first});
+  }
+  std::sort(keys.begin(), keys.end(), RankOrder{});
+  rankIndex = std::set< RankKey, RankOrder >(keys.begin(), keys.end());
 }
 
 std::pair< bool, gavrilova::GroupStatistics > gavrilova::StudentDatabase::getGroupStatistics
@@ -563,34 +788,26 @@ std::pair< bool, gavrilova::GroupStatistics > gavrilova::StudentDatabase::getGro
 std::vector< std::shared_ptr< const gavrilova::student::Student > >
 gavrilova::StudentDatabase::getTopStudents(size_t n) const
 {
-  std::vector< std::shared_ptr< const student::Student > > allStudents;
-  std::transform(students.begin(), students.end(),
-      std::back_inserter(allStudents),
-      PairToSecond< std::map< StudentID, std::shared_ptr< student::Student > >::value_type >());
-
   std::vector< std::shared_ptr< const student::Student > > result;
-  result.resize(std::min(n, allStudents.size()));
-
-  std::partial_sort_copy(allStudents.begin(), allStudents.end(),
-      result.begin(), result.end(),
-      CompareStudentsByGrade{});
-
+  result.reserve(std::min(n, rankIndex.size()));
+  for (auto it = rankIndex.begin(); it != rankIndex.end() && result.size() < n; ++it) {
+    result.push_back(students.at(it->id));
+  }
   return result;
 }
 
 std::vector< std::shared_ptr< const gavrilova::student::Student > >
 gavrilova::StudentDatabase::getRiskStudents(double threshold) const
 {
-  std::vector< std::pair< StudentID, std::shared_ptr< student::Student > > > temp;
-  std::copy_if(students.begin(), students.end(),
-      std::back_inserter(temp),
-      IsRiskStudentPredicate{threshold});
-
   std::vector< std::shared_ptr< const student::Student > > result;
-  std::transform(temp.begin(), temp.end(),
-      std::back_inserter(result),
-      PairToSecond< std::pair< StudentID, std::shared_ptr< student::Student > > >());
-
+  auto first = rankIndex.upper_bound(RankKey{threshold, std::numeric_limits< StudentID >::max()});
+  for (auto it = first; it != rankIndex.end(); ++it) {
+    const auto& student = students.at(it->id);
+    if (!student->grades_.empty()) {
+      result.push_back(student);
+    }
+  }
+  std::sort(result.begin(), result.end(), CompareStudentsById{});
   return result;
 }
 
@@ -622,12 +839,8 @@ gavrilova::StudentDatabase::getRiskStudentsInGroup(const std::string& groupName,
 
 std::pair< bool, double > gavrilova::StudentDatabase::getAverageGradeByDate(const date::Date& date) const
 {
-  auto it = dateToGradesIndex.find(date);
-  if (it == dateToGradesIndex.end()) return {false, 0.0};
-
-  const auto& grades = it->second;
-  double sum = std::accumulate(grades.begin(), grades.end(), 0.0,
-      GradePairAccumulator{});
+  auto it = dateAggregates.find(date);
+  if (it == dateAggregates.end()) return {false, 0.0};
 
-  return {true, sum / grades.size()};
+  return {true, static_cast< double >(it->second.sum) / it->second.count};
 }
@@ -26,6 +26,11 @@ namespace gavrilova {
     double allOtherGroupsAverage = 0.0;
   };
 
+  struct GradeLoadReport {
+    size_t accepted = 0;
+    size_t rejected = 0;
+  };
+
   class StudentDatabase {
   public:
     using Group = std::map< StudentID, std::shared_ptr< student::Student > >;
@@ -34,6 +39,8 @@ namespace gavrilova {
 
     bool saveToFile(const std::string& filename) const;
     bool loadFromFile(const std::string& filename);
+    bool saveSnapshot(const std::string& filename) const;
+    bool loadSnapshot(const std::string& filename);
     void clear();
 
     bool createGroup(const std::string& groupName);
@@ -58,6 +65,8 @@ namespace gavrilova {
     std::pair< bool, double > getAverageGradeByDate(const date::Date& date) const;
 
     bool loadGradesFromFile(const std::string& groupName, const date::Date& date, const std::string& filename);
+    std::pair< bool, GradeLoadReport > loadGradesBatched(const std::string& groupName,
+        const date::Date& date, const std::string& filename);
     bool exportGroupForGrading(const std::string& groupName, const std::string& filename) const;
     std::pair< bool, GroupStatistics > getGroupStatistics(const std::string& groupName, const DateRange& period) const;
 
@@ -65,11 +74,33 @@ namespace gavrilova {
     void updateStudentAverageGrade(std::shared_ptr< student::Student >& student);
 
   private:
+    struct RankKey {
+      double average;
+      StudentID id;
+    };
+
+    struct RankOrder {
+      bool operator()(const RankKey& a, const RankKey& b) const;
+    };
+
+    struct DateAggregate {
+      long long sum = 0;
+      size_t count = 0;
+    };
+
     std::map< StudentID, std::shared_ptr< student::Student > > students;
     std::map< std::string, Group > groups;
     std::map< std::string, std::set< StudentID > > nameToStudentIndex;
-    std::map< date::Date, std::vector< std::pair< StudentID, int > > > dateToGradesIndex;
+    std::map< date::Date, DateAggregate > dateAggregates;
+    std::set< RankKey, RankOrder > rankIndex;
     StudentID nextId;
+
+    void applyGradeDelta(student::Student& student, long long sumDelta);
+    void addToDateAggregate(const date::Date& date, int grade);
+    void removeFromDateAggregate(const date::Date& date, int grade);
+    void applyGradeBatch(std::vector< std::pair< StudentID, int > >& rows, const date::Date& date,
+        GradeLoadReport& report, std::vector< RankKey >& staleKeys);
+    void refreshRankIndex(const std::vector< RankKey >& staleKeys);
   };
 }
 
@@ -0,0 +1,174 @@
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include "StudentsDataBase.hpp"
+
+// Query benchmark: the rank index and per-date aggregates against full scans over every student.
+// Run with `make test-gavrilova.polina/F0 TEST_ARGS="--log_level=message -- <students> <grades>"`
+// (20000 students with 50 grades each by default).
+namespace {
+  using Clock = std::chrono::steady_clock;
+  using StudentList = std::vector< std::shared_ptr< const gavrilova::student::Student > >;
+
+  const size_t GROUP_COUNT = 100;
+
+  size_t benchmarkArg(int index, size_t fallback)
+  {
+    const auto& suite = boost::unit_test::framework::master_test_suite();
+    return suite.argc > index ? std::stoul(suite.argv[index]) : fallback;
+  }
+
+  std::string groupName(size_t index)
+  {
+    return "G" + std::to_string(index);
+  }
+
+  gavrilova::date::Date dayOf(int index)
+  {
+    return gavrilova::date::Date{2024, index / 28 % 12 + 1, index % 28 + 1};
+  }
+
+  void fillDatabase(gavrilova::StudentDatabase& db, size_t studentCount, size_t gradeCount)
+  {
+    std::mt19937 generator(5);
+    std::uniform_int_distribution< int > grade(2, 5);
+    std::vector< int > days(std::max< size_t >(gradeCount * 2, 1));
+    for (size_t i = 0; i < days.size(); ++i) {
+      days[i] = static_cast< int >(i);
+    }
+    for (size_t group = 0; group < GROUP_COUNT; ++group) {
+      db.createGroup(groupName(group));
+    }
+    for (size_t i = 0; i < studentCount; ++i) {
+      auto added = db.addStudent("Student " + std::to_string(i), groupName(i % GROUP_COUNT));
+      std::shuffle(days.begin(), days.end(), generator);
+      for (size_t j = 0; j < gradeCount; ++j) {
+        db.addGrade(added.second, grade(generator), dayOf(days[j]));
+      }
+    }
+  }
+
+  StudentList allStudents(const gavrilova::StudentDatabase& db)
+  {
+    StudentList all;
+    for (size_t group = 0; group < GROUP_COUNT; ++group) {
+      StudentList members = db.getStudentsInGroup(groupName(group));
+      all.insert(all.end(), members.begin(), members.end());
+    }
+    return all;
+  }
+
+  bool byGrade(const StudentList::value_type& a, const StudentList::value_type& b)
+  {
+    return a->averageGrade_ != b->averageGrade_ ? a->averageGrade_ > b->averageGrade_ : a->id_ < b->id_;
+  }
+
+  StudentList scanTop(const gavrilova::StudentDatabase& db, size_t n)
+  {
+    StudentList all = allStudents(db);
+    StudentList result(std::min(n, all.size()));
+    std::partial_sort_copy(all.begin(), all.end(), result.begin(), result.end(), byGrade);
+    return result;
+  }
+
+  StudentList scanRisk(const gavrilova::StudentDatabase& db, double threshold)
+  {
+    StudentList result;
+    for (const auto& student: allStudents(db)) {
+      if (!student->grades_.empty() && student->averageGrade_ < threshold) {
+        result.push_back(student);
+      }
+    }
+    std::sort(result.begin(), result.end(), [](const StudentList::value_type& a, const StudentList::value_type& b) {
+      return a->id_ < b->id_;
+    });
+    return result;
+  }
+
+  std::pair< bool, double > scanAverageByDate(const gavrilova::StudentDatabase& db, const gavrilova::date::Date& date)
+  {
+    long long sum = 0;
+    size_t count = 0;
+    for (const auto& student: allStudents(db)) {
+      auto it = student->grades_.find(date);
+      if (it != student->grades_.end()) {
+        sum += it->second;
+        ++count;
+      }
+    }
+    return {count != 0, count != 0 ? static_cast< double >(sum) / count : 0.0};
+  }
+
+  template < class F >
+  double millisecondsFor(size_t repeats, F query)
+  {
+    auto start = Clock::now();
+    for (size_t i = 0; i < repeats; ++i) {
+      query(i);
+    }
+    return std::chrono::duration< double, std::milli >(Clock::now() - start).count();
+  }
+
+  void checkSameStudents(const StudentList& actual, const StudentList& expected)
+  {
+    BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+      BOOST_CHECK_EQUAL(actual[i]->id_, expected[i]->id_);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(indexed_queries_match_scans_after_updates)
+{
+  gavrilova::StudentDatabase db;
+  fillDatabase(db, 2000, 10);
+  std::mt19937 generator(9);
+  std::uniform_int_distribution< unsigned long > id(1001, 3000);
+  std::uniform_int_distribution< int > day(0, 19);
+  for (size_t i = 0; i < 2000; ++i) {
+    db.changeGrade(id(generator), 5, dayOf(day(generator)));
+    db.removeGradesByDate(id(generator), dayOf(day(generator)));
+    db.addGrade(id(generator), 2, dayOf(day(generator)));
+  }
+  db.deleteStudent(1500);
+  checkSameStudents(db.getTopStudents(50), scanTop(db, 50));
+  checkSameStudents(db.getRiskStudents(3.5), scanRisk(db, 3.5));
+  for (int i = 0; i < 20; ++i) {
+    auto indexed = db.getAverageGradeByDate(dayOf(i));
+    auto scanned = scanAverageByDate(db, dayOf(i));
+    BOOST_CHECK_EQUAL(indexed.first, scanned.first);
+    BOOST_CHECK_CLOSE(indexed.second, scanned.second, 1e-9);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(query_benchmark)
+{
+  size_t studentCount = benchmarkArg(1, 20000);
+  size_t gradeCount = benchmarkArg(2, 50);
+  gavrilova::StudentDatabase db(7);
+  auto start = Clock::now();
+  fillDatabase(db, studentCount, gradeCount);
+  double buildTime = std::chrono::duration< double >(Clock::now() - start).count();
+
+  const size_t scans = 5;
+  const size_t lookups = 1000;
+  size_t found = 0;
+  double topIndex = millisecondsFor(lookups, [&](size_t) { found += db.getTopStudents(10).size(); });
+  double topScan = millisecondsFor(scans, [&](size_t) { found += scanTop(db, 10).size(); });
+  double riskIndex = millisecondsFor(lookups, [&](size_t) { found += db.getRiskStudents(3.0).size(); });
+  double riskScan = millisecondsFor(scans, [&](size_t) { found += scanRisk(db, 3.0).size(); });
+  double dateIndex = millisecondsFor(lookups, [&](size_t i) {
+    found += db.getAverageGradeByDate(dayOf(static_cast< int >(i % 56))).first;
+  });
+  double dateScan = millisecondsFor(scans, [&](size_t i) {
+    found += scanAverageByDate(db, dayOf(static_cast< int >(i % 56))).first;
+  });
+
+  checkSameStudents(db.getTopStudents(10), scanTop(db, 10));
+  BOOST_CHECK_GT(found, 0);
+  BOOST_TEST_MESSAGE(studentCount << " students x " << gradeCount << " grades, built in " << buildTime << " s");
+  BOOST_TEST_MESSAGE("per query, index vs scan: top 10 " << topIndex / lookups << " ms vs " << topScan / scans
+      << " ms; risk " << riskIndex / lookups << " ms vs " << riskScan / scans
+      << " ms; average by date " << dateIndex / lookups << " ms vs " << dateScan / scans << " ms");
+}
@@ -1,6 +1,7 @@
 #include "commands.hpp"
 #include "dataset.hpp"
 #include "huffman.hpp"
+#include "stream.hpp"
 #include <algorithm>
 #include <iomanip>
 #include <stdexcept>
@@ -114,6 +115,8 @@ void mazitov::getCmds(std::map< std::string, std::function< void(DataSetManager&
   cmds["load_text"] = loadTextCommand;
   cmds["compressedToBin"] = compressedToBinCommand;
   cmds["loadCompressed"] = loadCompressedCommand;
+  cmds["compressFile"] = compressFileCommand;
+  cmds["decompressFile"] = decompressFileCommand;
 }
 
 void mazitov::compressCommand(DataSetManager& mgmt, std::istream& in, std::ostream& out)
@@ -450,3 +453,41 @@ void mazitov::loadCompressedCommand(DataSetManager& mgmt, std::istream& in, std:
   ds->compressedBits = comprBits;
   out << "Compressed data loaded from " << filename << " to set " << setName << "\n";
 }
+
+void mazitov::compressFileCommand(DataSetManager&, std::istream& in, std::ostream& out)
+{
+  std::string source, target;
+  in >> source >> target;
+  std::ifstream input(source, std::ios::binary);
+  if (!input)
+  {
+    throw std::runtime_error("<FILE_NOT_FOUND>");
+  }
+  std::ofstream output(target, std::ios::binary);
+  if (!output)
+  {
+    throw std::runtime_error("<FILE_WRITE_ERROR>");
+  }
+  StreamStats stats = compressStream(input, output);
+  out << "File " << source << " (" << stats.originalBytes << " bytes) was compressed to ";
+  out << target << " (" << stats.compressedBytes << " bytes)\n";
+}
+
+void mazitov::decompressFileCommand(DataSetManager&, std::istream& in, std::ostream& out)
+{
+  std::string source, target;
+  in >> source >> target;
+  std::ifstream input(source, std::ios::binary);
+  if (!input)
+  {
+    throw std::runtime_error("<FILE_NOT_FOUND>");
+  }
+  std::ofstream output(target, std::ios::binary);
+  if (!output)
+  {
+    throw std::runtime_error("<FILE_WRITE_ERROR>");
+  }
+  StreamStats stats = decompressStream(input, output);
+  out << "File " << source << " (" << stats.compressedBytes << " bytes) was decompressed to ";
+  out << target << " (" << stats.originalBytes << " bytes)\n";
+}
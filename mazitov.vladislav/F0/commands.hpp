@@ -21,6 +21,8 @@ namespace mazitov
   void loadTextCommand(DataSetManager &, std::istream &, std::ostream &);
   void compressedToBinCommand(DataSetManager &, std::istream &, std::ostream &);
   void loadCompressedCommand(DataSetManager &, std::istream &, std::ostream &);
+  void compressFileCommand(DataSetManager &, std::istream &, std::ostream &);
+  void decompressFileCommand(DataSetManager &, std::istream &, std::ostream &);
 }
 
 #endif
@@ -1,5 +1,6 @@
 #include "dataset.hpp"
 #include "huffman.hpp"
+#include <stdexcept>
 
 bool mazitov::DataSetManager::createDataSet(const std::string& name)
 {
@@ -41,13 +42,14 @@ bool mazitov::DataSetManager::compressDataSet(const std::string& name)
   set->huffCodes.clear();
 
   auto freq = buildFreqTable(set->originalText);
-  auto root = buildHuffmanTree(freq);
-  if (root == nullptr)
+  auto tree = buildHuffmanTree(freq);
+  if (tree.root == -1)
   {
     return false;
   }
 
-  generateCodes(root, set->huffCodes);
+  set->canonCodes = buildCanonicalCodes(buildCodeLengths(tree));
+  canonicalToTable(set->canonCodes, set->huffCodes);
   return true;
 }
 
@@ -58,10 +60,21 @@ std::string mazitov::DataSetManager::getCompressedData(const std::string& name)
   {
     return "";
   }
+  const DataSet& set = it->second;
   std::string res;
-  for (char c : it->second.originalText)
+  for (char c : set.originalText)
   {
-    res += it->second.huffCodes.at(c);
+    unsigned char symbol = static_cast< unsigned char >(c);
+    std::size_t len = set.canonCodes.lengths[symbol];
+    if (len == 0)
+    {
+      throw std::out_of_range("<NO_CODE_FOR_SYMBOL>");
+    }
+    std::uint32_t code = set.canonCodes.codes[symbol];
+    for (std::size_t i = len; i > 0; i--)
+    {
+      res += ((code >> (i - 1)) & 1) ? '1' : '0';
+    }
   }
   return res;
 }
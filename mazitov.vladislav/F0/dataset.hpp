@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <map>
 #include <cstddef>
+#include "huffman.hpp"
 
 namespace mazitov
 {
@@ -14,6 +15,7 @@ namespace mazitov
     std::string originalText;
     std::string compressedBits;
     std::unordered_map< char, std::string > huffCodes;
+    CanonicalCodes canonCodes;
   };
 
   class DataSetManager
@@ -14,45 +14,40 @@ namespace
     }
   };
 
-  void treverseTree(const mazitov::huffPtr& node, const std::string& code, mazitov::huffCodesTable& codes)
+  void collectDepths(const mazitov::HuffmanTree& tree, int index, std::size_t depth, std::vector< std::size_t >& depths)
   {
-    if (node == nullptr)
+    const mazitov::HuffmanNode& node = tree.nodes[index];
+    if (node.left == -1 && node.right == -1)
     {
+      depths[index] = std::max< std::size_t >(depth, 1);
       return;
     }
-    if (node->left == nullptr && node->right == nullptr)
-    {
-      codes[node->symbol] = code;
-      return;
-    }
-    if (node->left != nullptr)
-    {
-      treverseTree(node->left, code + "0", codes);
-    }
-    if (node->right != nullptr)
-    {
-      treverseTree(node->right, code + "1", codes);
-    }
+    collectDepths(tree, node.left, depth + 1, depths);
+    collectDepths(tree, node.right, depth + 1, depths);
   }
 }
 
 mazitov::HuffmanNode::HuffmanNode(std::size_t freq, char symb):
   frequency(freq),
   symbol(symb),
-  left(nullptr),
-  right(nullptr)
+  left(-1),
+  right(-1)
 {}
 
-mazitov::HuffmanNode::HuffmanNode(const huffPtr& l, const huffPtr& r):
-  frequency(0),
+mazitov::HuffmanNode::HuffmanNode(std::size_t freq, int l, int r):
+  frequency(freq),
   symbol('\0'),
   left(l),
   right(r)
 {}
 
-bool mazitov::HuffmanNodeComparator::operator()(const huffPtr& lhs, const huffPtr& rhs) const
+mazitov::HuffmanNodeComparator::HuffmanNodeComparator(const std::vector< HuffmanNode >& n):
+  nodes(n)
+{}
+
+bool mazitov::HuffmanNodeComparator::operator()(int lhs, int rhs) const
 {
-  return lhs->frequency > rhs->frequency;
+  return nodes[lhs].frequency > nodes[rhs].frequency;
 }
 
 mazitov::freqTable mazitov::buildFreqTable(const std::string& text)
@@ -62,37 +57,126 @@ mazitov::freqTable mazitov::buildFreqTable(const std::string& text)
   return ft;
 }
 
-mazitov::huffPtr mazitov::buildHuffmanTree(const freqTable& freq)
+mazitov::HuffmanTree mazitov::buildHuffmanTree(const freqTable& freq)
 {
+  HuffmanTree tree{ {}, -1 };
   if (freq.empty())
   {
-    return nullptr;
+    return tree;
   }
 
-  std::priority_queue< huffPtr, std::vector< huffPtr >, HuffmanNodeComparator > pq;
+  tree.nodes.reserve(2 * freq.size() - 1);
+  std::vector< int > heap;
+  heap.reserve(freq.size());
+  HuffmanNodeComparator comp(tree.nodes);
+  std::priority_queue< int, std::vector< int >, HuffmanNodeComparator > pq(comp, std::move(heap));
   for (const auto& pair : freq)
   {
-    pq.push(std::make_shared< HuffmanNode >(pair.second, pair.first));
+    tree.nodes.emplace_back(pair.second, pair.first);
+    pq.push(static_cast< int >(tree.nodes.size() - 1));
   }
 
   while (pq.size() > 1)
   {
-    auto left = pq.top();
+    int left = pq.top();
     pq.pop();
-    auto right = pq.top();
+    int right = pq.top();
     pq.pop();
-    auto parent = std::make_shared< HuffmanNode >(left, right);
-    parent->frequency = left->frequency + right->frequency;
-    pq.push(parent);
+    tree.nodes.emplace_back(tree.nodes[left].frequency + tree.nodes[right].frequency, left, right);
+    pq.push(static_cast< int >(tree.nodes.size() - 1));
+  }
+  tree.root = pq.top();
+  return tree;
+}
+
+mazitov::codeLengths mazitov::buildCodeLengths(const HuffmanTree& tree)
+{
+  codeLengths lengths{};
+  if (tree.root == -1)
+  {
+    return lengths;
+  }
+  std::vector< std::size_t > depths(tree.nodes.size(), 0);
+  collectDepths(tree, tree.root, 0, depths);
+
+  const std::size_t maxLength = maxCodeLength;
+  const std::size_t capacity = std::size_t(1) << maxLength;
+  std::size_t kraft = 0;
+  for (std::size_t i = 0; i < depths.size(); i++)
+  {
+    if (depths[i] != 0)
+    {
+      depths[i] = std::min(depths[i], maxLength);
+      kraft += capacity >> depths[i];
+    }
   }
-  return pq.top();
+  while (kraft > capacity)
+  {
+    std::size_t best = depths.size();
+    for (std::size_t i = 0; i < depths.size(); i++)
+    {
+      if (depths[i] == 0 || depths[i] == maxLength)
+      {
+        continue;
+      }
+      if (best == depths.size() || depths[i] > depths[best]
+          || (depths[i] == depths[best] && tree.nodes[i].frequency < tree.nodes[best].frequency))
+      {
+        best = i;
+      }
+    }
+    depths[best]++;
+    kraft -= capacity >> depths[best];
+  }
+
+  for (std::size_t i = 0; i < depths.size(); i++)
+  {
+    if (depths[i] != 0)
+    {
+      lengths[static_cast< unsigned char >(tree.nodes[i].symbol)] = static_cast< unsigned char >(depths[i]);
+    }
+  }
+  return lengths;
+}
+
+mazitov::CanonicalCodes mazitov::buildCanonicalCodes(const codeLengths& lengths)
+{
+  CanonicalCodes result{ {}, lengths };
+  std::uint32_t code = 0;
+  std::size_t prevLength = 0;
+  for (std::size_t len = 1; len <= maxCodeLength; len++)
+  {
+    for (std::size_t symbol = 0; symbol < lengths.size(); symbol++)
+    {
+      if (lengths[symbol] != len)
+      {
+        continue;
+      }
+      code <<= (len - prevLength);
+      prevLength = len;
+      result.codes[symbol] = code++;
+    }
+  }
+  return result;
 }
 
-void mazitov::generateCodes(const huffPtr& root, std::unordered_map< char, std::string >& codes)
+void mazitov::canonicalToTable(const CanonicalCodes& canon, huffCodesTable& codes)
 {
-  if (root == nullptr)
+  for (std::size_t symbol = 0; symbol < canon.lengths.size(); symbol++)
   {
-    return;
+    std::size_t len = canon.lengths[symbol];
+    if (len == 0)
+    {
+      continue;
+    }
+    std::string code(len, '0');
+    for (std::size_t i = 0; i < len; i++)
+    {
+      if ((canon.codes[symbol] >> (len - i - 1)) & 1)
+      {
+        code[i] = '1';
+      }
+    }
+    codes[static_cast< char >(symbol)] = code;
   }
-  treverseTree(root, "", codes);
 }
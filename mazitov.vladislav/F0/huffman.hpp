@@ -1,39 +1,58 @@
 #ifndef HUFFMAN_HPP
 #define HUFFMAN_HPP
 
+#include <array>
 #include <cstddef>
-#include <memory>
+#include <cstdint>
 #include <unordered_map>
 #include <string>
 #include <queue>
+#include <vector>
 #include <algorithm>
 
 namespace mazitov
 {
-  struct HuffmanNode;
-  using huffPtr = std::shared_ptr< HuffmanNode >;
   using freqTable = std::unordered_map< char, std::size_t >;
   using huffCodesTable = std::unordered_map< char, std::string >;
+  using codeLengths = std::array< unsigned char, 256 >;
+
+  constexpr std::size_t maxCodeLength = 15;
+
+  struct CanonicalCodes
+  {
+    std::array< std::uint32_t, 256 > codes;
+    codeLengths lengths;
+  };
 
   struct HuffmanNode
   {
     std::size_t frequency;
     char symbol;
-    huffPtr left;
-    huffPtr right;
+    int left;
+    int right;
 
     HuffmanNode(std::size_t freq, char symb);
-    HuffmanNode(const huffPtr &, const huffPtr &);
+    HuffmanNode(std::size_t freq, int l, int r);
+  };
+
+  struct HuffmanTree
+  {
+    std::vector< HuffmanNode > nodes;
+    int root;
   };
 
   struct HuffmanNodeComparator
   {
-    bool operator()(const huffPtr &, const huffPtr &) const;
+    const std::vector< HuffmanNode >& nodes;
+    explicit HuffmanNodeComparator(const std::vector< HuffmanNode > &);
+    bool operator()(int, int) const;
   };
 
-  huffPtr buildHuffmanTree(const freqTable &);
+  HuffmanTree buildHuffmanTree(const freqTable &);
   freqTable buildFreqTable(const std::string &);
-  void generateCodes(const huffPtr &, huffCodesTable &);
+  codeLengths buildCodeLengths(const HuffmanTree &);
+  CanonicalCodes buildCanonicalCodes(const codeLengths &);
+  void canonicalToTable(const CanonicalCodes &, huffCodesTable &);
 }
 
 #endif
@@ -0,0 +1,256 @@
+#include "stream.hpp"
+#include "huffman.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+  constexpr std::size_t blockSize = 1 << 16;
+  constexpr char magic[] = { 'M', 'Z', 'H', 'C' };
+
+  void writeUint(std::ostream& out, unsigned long long value, std::size_t bytes)
+  {
+    for (std::size_t i = 0; i < bytes; i++)
+    {
+      out.put(static_cast< char >((value >> (8 * i)) & 0xFF));
+    }
+  }
+
+  unsigned long long readUint(std::istream& in, std::size_t bytes)
+  {
+    unsigned long long value = 0;
+    for (std::size_t i = 0; i < bytes; i++)
+    {
+      int byte = in.get();
+      if (byte == std::istream::traits_type::eof())
+      {
+        throw std::runtime_error("<INVALID_COMPRESSED_FILE>");
+      }
+      value |= static_cast< unsigned long long >(byte) << (8 * i);
+    }
+    return value;
+  }
+
+  struct BitWriter
+  {
+    std::ostream& out;
+    std::vector< char > buffer;
+    std::uint64_t current;
+    std::size_t filled;
+    std::size_t written;
+    explicit BitWriter(std::ostream& o):
+      out(o),
+      buffer(),
+      current(0),
+      filled(0),
+      written(0)
+    {
+      buffer.reserve(blockSize);
+    }
+    void operator()(std::uint32_t code, std::size_t len)
+    {
+      current = (current << len) | code;
+      filled += len;
+      while (filled >= 8)
+      {
+        filled -= 8;
+        push(static_cast< unsigned char >(current >> filled));
+      }
+    }
+    void push(unsigned char byte)
+    {
+      buffer.push_back(static_cast< char >(byte));
+      if (buffer.size() == blockSize)
+      {
+        flush();
+      }
+    }
+    void finish()
+    {
+      if (filled != 0)
+      {
+        push(static_cast< unsigned char >(current << (8 - filled)));
+        filled = 0;
+      }
+      flush();
+    }
+    void flush()
+    {
+      out.write(buffer.data(), buffer.size());
+      written += buffer.size();
+      buffer.clear();
+    }
+  };
+
+  struct CanonicalDecoder
+  {
+    std::array< std::size_t, mazitov::maxCodeLength + 1 > count;
+    std::vector< unsigned char > symbols;
+    explicit CanonicalDecoder(const mazitov::codeLengths& lengths):
+      count(),
+      symbols()
+    {
+      for (std::size_t len = 1; len <= mazitov::maxCodeLength; len++)
+      {
+        for (std::size_t symbol = 0; symbol < lengths.size(); symbol++)
+        {
+          if (lengths[symbol] == len)
+          {
+            count[len]++;
+            symbols.push_back(static_cast< unsigned char >(symbol));
+          }
+        }
+      }
+    }
+  };
+}
+
+mazitov::StreamStats mazitov::compressStream(std::istream& in, std::ostream& out)
+{
+  std::array< std::size_t, 256 > counts{};
+  std::vector< char > block(blockSize);
+  std::size_t total = 0;
+  while (in.read(block.data(), block.size()) || in.gcount() > 0)
+  {
+    std::size_t count = static_cast< std::size_t >(in.gcount());
+    for (std::size_t i = 0; i < count; i++)
+    {
+      counts[static_cast< unsigned char >(block[i])]++;
+    }
+    total += count;
+  }
+  freqTable freq;
+  for (std::size_t i = 0; i < counts.size(); i++)
+  {
+    if (counts[i] != 0)
+    {
+      freq[static_cast< char >(i)] = counts[i];
+    }
+  }
+  CanonicalCodes canon = buildCanonicalCodes(buildCodeLengths(buildHuffmanTree(freq)));
+
+  out.write(magic, sizeof(magic));
+  writeUint(out, total, 8);
+  std::size_t symbols = 256 - std::count(canon.lengths.begin(), canon.lengths.end(), 0);
+  writeUint(out, symbols, 2);
+  for (std::size_t symbol = 0; symbol < canon.lengths.size(); symbol++)
+  {
+    if (canon.lengths[symbol] != 0)
+    {
+      out.put(static_cast< char >(symbol));
+      out.put(static_cast< char >(canon.lengths[symbol]));
+    }
+  }
+  std::size_t headerSize = static_cast< std::size_t >(out.tellp());
+
+  in.clear();
+  in.seekg(0, std::ios::beg);
+  BitWriter writer(out);
+  while (in.read(block.data(), block.size()) || in.gcount() > 0)
+  {
+    std::size_t count = static_cast< std::size_t >(in.gcount());
+    for (std::size_t i = 0; i < count; i++)
+    {
+      unsigned char symbol = static_cast< unsigned char >(block[i]);
+      if (canon.lengths[symbol] == 0)
+      {
+        throw std::runtime_error("<FILE_CHANGED_DURING_COMPRESSION>");
+      }
+      writer(canon.codes[symbol], canon.lengths[symbol]);
+    }
+  }
+  writer.finish();
+  if (!out)
+  {
+    throw std::runtime_error("<FILE_WRITE_ERROR>");
+  }
+  return StreamStats{ total, headerSize + writer.written };
+}
+
+mazitov::StreamStats mazitov::decompressStream(std::istream& in, std::ostream& out)
+{
+  char header[sizeof(magic)] = {};
+  if (!in.read(header, sizeof(header)) || !std::equal(header, header + sizeof(header), magic))
+  {
+    throw std::runtime_error("<INVALID_COMPRESSED_FILE>");
+  }
+  std::size_t total = readUint(in, 8);
+  std::size_t symbols = readUint(in, 2);
+  codeLengths lengths{};
+  std::size_t kraft = 0;
+  for (std::size_t s = 0; s < symbols; s++)
+  {
+    std::size_t symbol = readUint(in, 1);
+    std::size_t length = readUint(in, 1);
+    if (length == 0 || length > maxCodeLength || lengths[symbol] != 0)
+    {
+      throw std::runtime_error("<INVALID_COMPRESSED_FILE>");
+    }
+    lengths[symbol] = static_cast< unsigned char >(length);
+    kraft += std::size_t(1) << (maxCodeLength - length);
+  }
+  if (kraft > (std::size_t(1) << maxCodeLength))
+  {
+    throw std::runtime_error("<INVALID_COMPRESSED_FILE>");
+  }
+  CanonicalDecoder decoder(lengths);
+  std::size_t compressed = static_cast< std::size_t >(in.tellg());
+
+  std::vector< char > block(blockSize);
+  std::vector< char > result;
+  result.reserve(blockSize);
+  std::size_t decoded = 0;
+  std::size_t code = 0;
+  std::size_t first = 0;
+  std::size_t index = 0;
+  std::size_t len = 1;
+  while (decoded < total && (in.read(block.data(), block.size()) || in.gcount() > 0))
+  {
+    std::size_t count = static_cast< std::size_t >(in.gcount());
+    compressed += count;
+    for (std::size_t i = 0; i < count && decoded < total; i++)
+    {
+      unsigned char byte = static_cast< unsigned char >(block[i]);
+      for (int j = 7; j >= 0 && decoded < total; j--)
+      {
+        code |= (byte >> j) & 1;
+        std::size_t lengthCount = decoder.count[len];
+        if (code < first + lengthCount)
+        {
+          result.push_back(static_cast< char >(decoder.symbols[index + code - first]));
+          decoded++;
+          code = 0;
+          first = 0;
+          index = 0;
+          len = 1;
+          if (result.size() == blockSize)
+          {
+            out.write(result.data(), result.size());
+            result.clear();
+          }
+          continue;
+        }
+        if (++len > maxCodeLength)
+        {
+          throw std::runtime_error("<INVALID_COMPRESSED_FILE>");
+        }
+        index += lengthCount;
+        first = (first + lengthCount) << 1;
+        code <<= 1;
+      }
+    }
+  }
+  out.write(result.data(), result.size());
+  if (decoded != total)
+  {
+    throw std::runtime_error("<INVALID_COMPRESSED_FILE>");
+  }
+  if (!out)
+  {
+    throw std::runtime_error("<FILE_WRITE_ERROR>");
+  }
+  return StreamStats{ total, compressed };
+}
@@ -0,0 +1,20 @@
+#ifndef STREAM_HPP
+#define STREAM_HPP
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+
+namespace mazitov
+{
+  struct StreamStats
+  {
+    std::size_t originalBytes;
+    std::size_t compressedBytes;
+  };
+
+  StreamStats compressStream(std::istream &, std::ostream &);
+  StreamStats decompressStream(std::istream &, std::ostream &);
+}
+
+#endif
@@ -0,0 +1,196 @@
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include "huffman.hpp"
+
+// Tree building microbenchmark: the node pool against the former shared_ptr tree, over many 256-symbol datasets.
+// Run with `make test-mazitov.vladislav/F0 TEST_ARGS="--log_level=message -- <datasets>"` (200 by default).
+namespace
+{
+  std::size_t allocations = 0;
+}
+
+void * operator new(std::size_t size)
+{
+  ++allocations;
+  void * ptr = std::malloc(size ? size : 1);
+  if (!ptr)
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  struct LegacyNode;
+  using legacyPtr = std::shared_ptr< LegacyNode >;
+
+  struct LegacyNode
+  {
+    std::size_t frequency;
+    char symbol;
+    legacyPtr left;
+    legacyPtr right;
+  };
+
+  struct LegacyComparator
+  {
+    bool operator()(const legacyPtr & lhs, const legacyPtr & rhs) const
+    {
+      return lhs->frequency > rhs->frequency;
+    }
+  };
+
+  legacyPtr buildLegacyTree(const mazitov::freqTable & freq)
+  {
+    std::priority_queue< legacyPtr, std::vector< legacyPtr >, LegacyComparator > pq;
+    for (const auto & pair : freq)
+    {
+      pq.push(std::make_shared< LegacyNode >(LegacyNode{ pair.second, pair.first, nullptr, nullptr }));
+    }
+    while (pq.size() > 1)
+    {
+      auto left = pq.top();
+      pq.pop();
+      auto right = pq.top();
+      pq.pop();
+      pq.push(std::make_shared< LegacyNode >(LegacyNode{ left->frequency + right->frequency, '\0', left, right }));
+    }
+    return pq.top();
+  }
+
+  void traverseLegacyTree(const legacyPtr & node, const std::string & code, mazitov::huffCodesTable & codes)
+  {
+    if (!node->left && !node->right)
+    {
+      codes[node->symbol] = code;
+      return;
+    }
+    traverseLegacyTree(node->left, code + "0", codes);
+    traverseLegacyTree(node->right, code + "1", codes);
+  }
+
+  std::size_t benchmarkDatasets()
+  {
+    const auto & suite = boost::unit_test::framework::master_test_suite();
+    return suite.argc > 1 ? std::stoul(suite.argv[1]) : 200;
+  }
+
+  std::vector< mazitov::freqTable > makeDatasets(std::size_t count)
+  {
+    std::mt19937 generator(7);
+    std::uniform_int_distribution< std::size_t > frequency(1, 100000);
+    std::vector< mazitov::freqTable > datasets(count);
+    for (auto & freq : datasets)
+    {
+      for (int symbol = 0; symbol < 256; symbol++)
+      {
+        freq[static_cast< char >(symbol)] = frequency(generator);
+      }
+    }
+    return datasets;
+  }
+
+  std::size_t codedSize(const mazitov::freqTable & freq, const mazitov::huffCodesTable & codes)
+  {
+    std::size_t bits = 0;
+    for (const auto & pair : freq)
+    {
+      bits += pair.second * codes.at(pair.first).size();
+    }
+    return bits;
+  }
+
+  std::size_t codedSize(const mazitov::HuffmanTree & tree)
+  {
+    std::size_t bits = 0;
+    for (const auto & node : tree.nodes)
+    {
+      bits += node.left != -1 ? node.frequency : 0;
+    }
+    return bits;
+  }
+
+  struct Measurement
+  {
+    double microseconds;
+    double allocations;
+  };
+
+  template< class F >
+  Measurement measure(const std::vector< mazitov::freqTable > & datasets, F run)
+  {
+    std::size_t before = allocations;
+    auto start = Clock::now();
+    for (const auto & freq : datasets)
+    {
+      run(freq);
+    }
+    std::chrono::duration< double, std::micro > elapsed = Clock::now() - start;
+    double count = static_cast< double >(datasets.size());
+    return Measurement{ elapsed.count() / count, (allocations - before) / count };
+  }
+
+  void report(const char * stage, const Measurement & legacy, const Measurement & pool)
+  {
+    BOOST_TEST_MESSAGE(stage << " per dataset: shared_ptr " << legacy.microseconds << " us, " << legacy.allocations
+        << " allocations; node pool " << pool.microseconds << " us, " << pool.allocations << " allocations");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(node_pool_builds_optimal_tree)
+{
+  for (const auto & freq : makeDatasets(20))
+  {
+    mazitov::huffCodesTable legacyCodes;
+    traverseLegacyTree(buildLegacyTree(freq), "", legacyCodes);
+    BOOST_CHECK_EQUAL(codedSize(mazitov::buildHuffmanTree(freq)), codedSize(freq, legacyCodes));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(node_pool_benchmark)
+{
+  std::vector< mazitov::freqTable > datasets = makeDatasets(benchmarkDatasets());
+  std::size_t roots = 0;
+
+  Measurement legacyBuild = measure(datasets, [&roots](const mazitov::freqTable & freq)
+  {
+    roots += buildLegacyTree(freq)->frequency != 0;
+  });
+  Measurement poolBuild = measure(datasets, [&roots](const mazitov::freqTable & freq)
+  {
+    roots += mazitov::buildHuffmanTree(freq).root != -1;
+  });
+  report("tree build", legacyBuild, poolBuild);
+
+  Measurement legacyCodes = measure(datasets, [](const mazitov::freqTable & freq)
+  {
+    mazitov::huffCodesTable codes;
+    traverseLegacyTree(buildLegacyTree(freq), "", codes);
+  });
+  Measurement poolCodes = measure(datasets, [](const mazitov::freqTable & freq)
+  {
+    mazitov::huffCodesTable codes;
+    mazitov::canonicalToTable(mazitov::buildCanonicalCodes(mazitov::buildCodeLengths(mazitov::buildHuffmanTree(freq))), codes);
+  });
+  report("build and code table", legacyCodes, poolCodes);
+
+  BOOST_CHECK_EQUAL(roots, 2 * datasets.size());
+  BOOST_CHECK_LT(poolBuild.allocations, legacyBuild.allocations);
+}
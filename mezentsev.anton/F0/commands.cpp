@@ -89,16 +89,13 @@ namespace
     mergeDictionary(std::next(it), end, result);
   }
 
-  void collectSuggestions(const mezentsev::Dictionary& dict, mezentsev::Dictionary::const_iterator it,
-      const std::string& prefix, int n, std::vector< std::string >& result)
+  template< typename It >
+  void insertWords(It it, It end, mezentsev::PrefixIndex& index)
   {
-    if (n == 0 || it == dict.end() || it->first.substr(0, prefix.size()) != prefix)
+    for (; it != end; ++it)
     {
-      return;
+      index.insert(it->first);
     }
-
-    result.push_back(it->first);
-    collectSuggestions(dict, std::next(it), prefix, n - 1, result);
   }
 
   void collectWordsByPrefix(mezentsev::Dictionary::const_iterator it,
@@ -244,7 +241,7 @@ std::vector< std::string > mezentsev::split(const std::string& s, char delim)
   return tokens;
 }
 
-void mezentsev::addCommand(DictionarySet& dicts, const std::vector< std::string >& tokens)
+void mezentsev::addCommand(DictionarySet& dicts, IndexSet& indexes, const std::vector< std::string >& tokens)
 {
   if (tokens.size() < 4)
   {
@@ -262,6 +259,11 @@ void mezentsev::addCommand(DictionarySet& dicts, const std::vector< std::string
   if (word_it == dict.end())
   {
     dict[tokens[2]] = Translations{ tokens[3] };
+    auto index_it = indexes.find(tokens[1]);
+    if (index_it != indexes.end())
+    {
+      index_it->second.insert(tokens[2]);
+    }
   }
   else
   {
@@ -276,7 +278,7 @@ void mezentsev::addCommand(DictionarySet& dicts, const std::vector< std::string
   }
 }
 
-void mezentsev::removeCommand(DictionarySet& dicts, const std::vector< std::string >& tokens)
+void mezentsev::removeCommand(DictionarySet& dicts, IndexSet& indexes, const std::vector< std::string >& tokens)
 {
   if (tokens.size() < 3)
   {
@@ -296,9 +298,14 @@ void mezentsev::removeCommand(DictionarySet& dicts, const std::vector< std::stri
     std::cout << "WORD NOT FOUND" << std::endl;
     return;
   }
+  auto index_it = indexes.find(tokens[1]);
   if (tokens.size() == 3)
   {
     dict.erase(word_it);
+    if (index_it != indexes.end())
+    {
+      index_it->second.erase(tokens[2]);
+    }
   }
   else
   {
@@ -313,6 +320,10 @@ void mezentsev::removeCommand(DictionarySet& dicts, const std::vector< std::stri
       if (word_it->second.empty())
       {
         dict.erase(word_it);
+        if (index_it != indexes.end())
+        {
+          index_it->second.erase(tokens[2]);
+        }
       }
     }
   }
@@ -397,7 +408,7 @@ void mezentsev::saveCommand(DictionarySet& dicts, const std::vector< std::string
   ofs << content;
 }
 
-void mezentsev::loadCommand(DictionarySet& dicts, const std::vector< std::string >& tokens)
+void mezentsev::loadCommand(DictionarySet& dicts, IndexSet& indexes, const std::vector< std::string >& tokens)
 {
   if (tokens.size() < 3)
   {
@@ -420,6 +431,7 @@ void mezentsev::loadCommand(DictionarySet& dicts, const std::vector< std::string
   processFileLines(ifs, dict, line);
 
   dicts[tokens[1]] = dict;
+  indexes.erase(tokens[1]);
 }
 
 void mezentsev::countCommand(DictionarySet& dicts, const std::vector< std::string >& tokens)
@@ -438,7 +450,7 @@ void mezentsev::countCommand(DictionarySet& dicts, const std::vector< std::strin
   std::cout << dict_it->second.size() << std::endl;
 }
 
-void mezentsev::clearCommand(DictionarySet& dicts, const std::vector< std::string >& tokens)
+void mezentsev::clearCommand(DictionarySet& dicts, IndexSet& indexes, const std::vector< std::string >& tokens)
 {
   if (tokens.size() < 2)
   {
@@ -452,9 +464,10 @@ void mezentsev::clearCommand(DictionarySet& dicts, const std::vector< std::strin
     return;
   }
   dict_it->second.clear();
+  indexes.erase(tokens[1]);
 }
 
-void mezentsev::suggestCommand(DictionarySet& dicts, const std::vector< std::string >& tokens)
+void mezentsev::suggestCommand(DictionarySet& dicts, IndexSet& indexes, const std::vector< std::string >& tokens)
 {
   if (tokens.size() < 4)
   {
@@ -470,14 +483,18 @@ void mezentsev::suggestCommand(DictionarySet& dicts, const std::vector< std::str
   const Dictionary& dict = dict_it->second;
   std::string prefix = tokens[2];
   int n = std::stoi(tokens[3]);
+  auto index_it = indexes.find(tokens[1]);
+  if (index_it == indexes.end())
+  {
+    index_it = indexes.emplace(tokens[1], PrefixIndex(dict.begin(), dict.end())).first;
+  }
   std::vector< std::string > suggestions;
-  auto it = dict.lower_bound(prefix);
-  collectSuggestions(dict, it, prefix, n, suggestions);
+  index_it->second.suggest(prefix, std::max(n, 0), suggestions);
   suggestions.resize(n, "<EMPTY>");
   std::copy(suggestions.begin(), suggestions.end(), std::ostream_iterator< std::string >(std::cout, "\n"));
 }
 
-void mezentsev::mergeCommand(DictionarySet& dicts, const std::vector< std::string >& tokens)
+void mezentsev::mergeCommand(DictionarySet& dicts, IndexSet& indexes, const std::vector< std::string >& tokens)
 {
   if (tokens.size() < 4)
   {
@@ -500,12 +517,38 @@ void mezentsev::mergeCommand(DictionarySet& dicts, const std::vector< std::strin
 
   mergeDictionaryEntries(it2->second.begin(), it2->second.end(), merged);
 
+  auto index1 = indexes.find(tokens[1]);
+  auto index2 = indexes.find(tokens[2]);
+  bool indexed = index1 != indexes.end() || index2 != indexes.end();
+  PrefixIndex merged_index;
+  if (index1 != indexes.end())
+  {
+    merged_index = std::move(index1->second);
+    insertWords(it2->second.begin(), it2->second.end(), merged_index);
+  }
+  else if (index2 != indexes.end())
+  {
+    merged_index = std::move(index2->second);
+    insertWords(it1->second.begin(), it1->second.end(), merged_index);
+  }
+
   dicts[tokens[3]] = merged;
   dicts.erase(it1);
   dicts.erase(it2);
+
+  if (indexed)
+  {
+    indexes[tokens[3]] = std::move(merged_index);
+  }
+  else
+  {
+    indexes.erase(tokens[3]);
+  }
+  indexes.erase(tokens[1]);
+  indexes.erase(tokens[2]);
 }
 
-void mezentsev::diffCommand(DictionarySet& dicts, const std::vector< std::string >& tokens)
+void mezentsev::diffCommand(DictionarySet& dicts, IndexSet& indexes, const std::vector< std::string >& tokens)
 {
   if (tokens.size() < 4)
   {
@@ -533,10 +576,11 @@ void mezentsev::diffCommand(DictionarySet& dicts, const std::vector< std::string
   else
   {
     dicts[tokens[3]] = diff_dict;
+    indexes.erase(tokens[3]);
   }
 }
 
-void mezentsev::copyCommand(DictionarySet& dicts, const std::vector< std::string >& tokens)
+void mezentsev::copyCommand(DictionarySet& dicts, IndexSet& indexes, const std::vector< std::string >& tokens)
 {
   if (tokens.size() < 3)
   {
@@ -550,9 +594,18 @@ void mezentsev::copyCommand(DictionarySet& dicts, const std::vector< std::string
     return;
   }
   dicts[tokens[2]] = source_it->second;
+  auto index_it = indexes.find(tokens[1]);
+  if (index_it != indexes.end())
+  {
+    indexes[tokens[2]] = index_it->second;
+  }
+  else
+  {
+    indexes.erase(tokens[2]);
+  }
 }
 
-void mezentsev::intersectCommand(DictionarySet& dicts, const std::vector< std::string >& tokens)
+void mezentsev::intersectCommand(DictionarySet& dicts, IndexSet& indexes, const std::vector< std::string >& tokens)
 {
   if (tokens.size() < 4)
   {
@@ -582,10 +635,11 @@ void mezentsev::intersectCommand(DictionarySet& dicts, const std::vector< std::s
   else
   {
     dicts[tokens[3]] = intersect_dict;
+    indexes.erase(tokens[3]);
   }
 }
 
-void mezentsev::exportCommand(DictionarySet& dicts, const std::vector< std::string >& tokens)
+void mezentsev::exportCommand(DictionarySet& dicts, IndexSet& indexes, const std::vector< std::string >& tokens)
 {
   if (tokens.size() < 4)
   {
@@ -618,4 +672,9 @@ void mezentsev::exportCommand(DictionarySet& dicts, const std::vector< std::stri
   }
 
   exportWords(words_to_export.begin(), words_to_export.end(), target_dict);
+  auto index_it = indexes.find(tokens[3]);
+  if (index_it != indexes.end())
+  {
+    insertWords(words_to_export.begin(), words_to_export.end(), index_it->second);
+  }
 }
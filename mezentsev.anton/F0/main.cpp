@@ -56,6 +56,7 @@ int main(int argc, char* argv[])
 {
   using namespace mezentsev;
   DictionarySet dicts;
+  IndexSet indexes;
   if (argc > 1)
   {
     std::ifstream file(argv[1]);
@@ -71,20 +72,20 @@ int main(int argc, char* argv[])
   std::map< std::string, std::function< void(const std::vector< std::string >&) > > commands;
   using namespace std::placeholders;
 
-  commands.insert(std::make_pair("add", std::bind(addCommand,std::ref(dicts), _1)));
-  commands.insert(std::make_pair("remove", std::bind(removeCommand, std::ref(dicts), _1)));
+  commands.insert(std::make_pair("add", std::bind(addCommand, std::ref(dicts), std::ref(indexes), _1)));
+  commands.insert(std::make_pair("remove", std::bind(removeCommand, std::ref(dicts), std::ref(indexes), _1)));
   commands.insert(std::make_pair("translate", std::bind(translateCommand, std::ref(dicts), _1)));
   commands.insert(std::make_pair("list", std::bind(listCommand, std::ref(dicts), _1)));
   commands.insert(std::make_pair("save", std::bind(saveCommand, std::ref(dicts), _1)));
-  commands.insert(std::make_pair("load", std::bind(loadCommand, std::ref(dicts), _1)));
+  commands.insert(std::make_pair("load", std::bind(loadCommand, std::ref(dicts), std::ref(indexes), _1)));
   commands.insert(std::make_pair("count", std::bind(countCommand, std::ref(dicts), _1)));
-  commands.insert(std::make_pair("clear", std::bind(clearCommand, std::ref(dicts), _1)));
-  commands.insert(std::make_pair("suggest", std::bind(suggestCommand, std::ref(dicts), _1)));
-  commands.insert(std::make_pair("merge", std::bind(mergeCommand, std::ref(dicts), _1)));
-  commands.insert(std::make_pair("diff", std::bind(diffCommand, std::ref(dicts), _1)));
-  commands.insert(std::make_pair("copy", std::bind(copyCommand, std::ref(dicts), _1)));
-  commands.insert(std::make_pair("intersect", std::bind(intersectCommand, std::ref(dicts), _1)));
-  commands.insert(std::make_pair("export", std::bind(exportCommand, std::ref(dicts), _1)));
+  commands.insert(std::make_pair("clear", std::bind(clearCommand, std::ref(dicts), std::ref(indexes), _1)));
+  commands.insert(std::make_pair("suggest", std::bind(suggestCommand, std::ref(dicts), std::ref(indexes), _1)));
+  commands.insert(std::make_pair("merge", std::bind(mergeCommand, std::ref(dicts), std::ref(indexes), _1)));
+  commands.insert(std::make_pair("diff", std::bind(diffCommand, std::ref(dicts), std::ref(indexes), _1)));
+  commands.insert(std::make_pair("copy", std::bind(copyCommand, std::ref(dicts), std::ref(indexes), _1)));
+  commands.insert(std::make_pair("intersect", std::bind(intersectCommand, std::ref(dicts), std::ref(indexes), _1)));
+  commands.insert(std::make_pair("export", std::bind(exportCommand, std::ref(dicts), std::ref(indexes), _1)));
 
   std::string line;
   while (std::getline(std::cin, line))
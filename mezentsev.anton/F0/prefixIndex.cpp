@@ -0,0 +1,248 @@
+#include "prefixIndex.h"
+#include <algorithm>
+
+namespace
+{
+  const size_t NONE = static_cast< size_t >(-1);
+
+  bool lessByte(char a, char b)
+  {
+    return static_cast< unsigned char >(a) < static_cast< unsigned char >(b);
+  }
+
+  size_t commonPrefix(const std::string& label, const std::string& word, size_t pos)
+  {
+    size_t len = 0;
+    while (len < label.size() && pos + len < word.size() && label[len] == word[pos + len])
+    {
+      ++len;
+    }
+    return len;
+  }
+}
+
+mezentsev::PrefixIndex::PrefixIndex():
+  nodes_(1, Node{ "", {}, 0, false }),
+  free_()
+{}
+
+size_t mezentsev::PrefixIndex::newNode(const std::string& label)
+{
+  if (free_.empty())
+  {
+    nodes_.push_back(Node{ label, {}, 0, false });
+    return nodes_.size() - 1;
+  }
+  size_t node = free_.back();
+  free_.pop_back();
+  nodes_[node] = Node{ label, {}, 0, false };
+  return node;
+}
+
+size_t mezentsev::PrefixIndex::findChild(size_t node, char c) const
+{
+  const std::vector< size_t >& children = nodes_[node].children;
+  size_t lo = 0;
+  size_t hi = children.size();
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    char first = nodes_[children[mid]].label[0];
+    if (first == c)
+    {
+      return children[mid];
+    }
+    if (lessByte(first, c))
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return NONE;
+}
+
+void mezentsev::PrefixIndex::attachChild(size_t parent, size_t child)
+{
+  char first = nodes_[child].label[0];
+  std::vector< size_t >& children = nodes_[parent].children;
+  auto pos = children.begin();
+  while (pos != children.end() && lessByte(nodes_[*pos].label[0], first))
+  {
+    ++pos;
+  }
+  children.insert(pos, child);
+}
+
+void mezentsev::PrefixIndex::release(size_t node)
+{
+  for (size_t child: nodes_[node].children)
+  {
+    release(child);
+  }
+  nodes_[node] = Node{ "", {}, 0, false };
+  free_.push_back(node);
+}
+
+void mezentsev::PrefixIndex::mergeWithChild(size_t node)
+{
+  Node& current = nodes_[node];
+  if (node == 0 || current.terminal || current.children.size() != 1)
+  {
+    return;
+  }
+  size_t child = current.children.front();
+  current.label += nodes_[child].label;
+  current.terminal = nodes_[child].terminal;
+  current.children.swap(nodes_[child].children);
+  nodes_[child].children.clear();
+  release(child);
+}
+
+bool mezentsev::PrefixIndex::insert(const std::string& word)
+{
+  std::vector< size_t > path(1, 0);
+  size_t node = 0;
+  size_t pos = 0;
+  while (pos < word.size())
+  {
+    size_t child = findChild(node, word[pos]);
+    if (child == NONE)
+    {
+      size_t leaf = newNode(word.substr(pos));
+      attachChild(node, leaf);
+      path.push_back(leaf);
+      pos = word.size();
+      node = leaf;
+      break;
+    }
+    size_t len = commonPrefix(nodes_[child].label, word, pos);
+    if (len < nodes_[child].label.size())
+    {
+      size_t mid = newNode(nodes_[child].label.substr(0, len));
+      nodes_[child].label.erase(0, len);
+      nodes_[mid].words = nodes_[child].words;
+      nodes_[mid].children.push_back(child);
+      std::replace(nodes_[node].children.begin(), nodes_[node].children.end(), child, mid);
+      child = mid;
+    }
+    path.push_back(child);
+    node = child;
+    pos += len;
+  }
+
+  if (nodes_[node].terminal)
+  {
+    return false;
+  }
+  nodes_[node].terminal = true;
+  for (size_t step: path)
+  {
+    ++nodes_[step].words;
+  }
+  return true;
+}
+
+bool mezentsev::PrefixIndex::erase(const std::string& word)
+{
+  std::vector< size_t > path(1, 0);
+  size_t node = 0;
+  size_t pos = 0;
+  while (pos < word.size())
+  {
+    size_t child = findChild(node, word[pos]);
+    if (child == NONE || word.compare(pos, nodes_[child].label.size(), nodes_[child].label) != 0)
+    {
+      return false;
+    }
+    pos += nodes_[child].label.size();
+    path.push_back(child);
+    node = child;
+  }
+  if (!nodes_[node].terminal)
+  {
+    return false;
+  }
+
+  nodes_[node].terminal = false;
+  for (size_t step: path)
+  {
+    --nodes_[step].words;
+  }
+
+  size_t depth = path.size() - 1;
+  while (depth > 0 && nodes_[path[depth]].words == 0)
+  {
+    --depth;
+  }
+  if (depth + 1 < path.size())
+  {
+    std::vector< size_t >& children = nodes_[path[depth]].children;
+    children.erase(std::find(children.begin(), children.end(), path[depth + 1]));
+    release(path[depth + 1]);
+  }
+  mergeWithChild(path[depth]);
+  return true;
+}
+
+void mezentsev::PrefixIndex::clear()
+{
+  nodes_.assign(1, Node{ "", {}, 0, false });
+  free_.clear();
+}
+
+size_t mezentsev::PrefixIndex::size() const
+{
+  return nodes_[0].words;
+}
+
+void mezentsev::PrefixIndex::collect(size_t node, std::string& path, size_t n,
+    std::vector< std::string >& result) const
+{
+  if (nodes_[node].terminal)
+  {
+    result.push_back(path);
+  }
+  for (size_t child: nodes_[node].children)
+  {
+    if (result.size() >= n)
+    {
+      return;
+    }
+    path += nodes_[child].label;
+    collect(child, path, n, result);
+    path.resize(path.size() - nodes_[child].label.size());
+  }
+}
+
+void mezentsev::PrefixIndex::suggest(const std::string& prefix, size_t n, std::vector< std::string >& result) const
+{
+  if (n == 0)
+  {
+    return;
+  }
+  size_t node = 0;
+  size_t pos = 0;
+  std::string path;
+  while (pos < prefix.size())
+  {
+    size_t child = findChild(node, prefix[pos]);
+    if (child == NONE)
+    {
+      return;
+    }
+    const std::string& label = nodes_[child].label;
+    size_t len = commonPrefix(label, prefix, pos);
+    if (pos + len < prefix.size() && len < label.size())
+    {
+      return;
+    }
+    path += label;
+    pos += label.size();
+    node = child;
+  }
+  size_t limit = result.size() + n;
+  collect(node, path, limit, result);
+}
@@ -0,0 +1,51 @@
+#ifndef PREFIX_INDEX_H
+#define PREFIX_INDEX_H
+
+#include <string>
+#include <vector>
+
+namespace mezentsev
+{
+  class PrefixIndex
+  {
+  public:
+    PrefixIndex();
+    template< typename It >
+    PrefixIndex(It first, It last);
+
+    bool insert(const std::string& word);
+    bool erase(const std::string& word);
+    void clear();
+    size_t size() const;
+    void suggest(const std::string& prefix, size_t n, std::vector< std::string >& result) const;
+  private:
+    struct Node
+    {
+      std::string label;
+      std::vector< size_t > children;
+      size_t words;
+      bool terminal;
+    };
+
+    std::vector< Node > nodes_;
+    std::vector< size_t > free_;
+
+    size_t newNode(const std::string& label);
+    size_t findChild(size_t node, char c) const;
+    void attachChild(size_t parent, size_t child);
+    void release(size_t node);
+    void mergeWithChild(size_t node);
+    void collect(size_t node, std::string& path, size_t n, std::vector< std::string >& result) const;
+  };
+
+  template< typename It >
+  PrefixIndex::PrefixIndex(It first, It last):
+    PrefixIndex()
+  {
+    for (; first != last; ++first)
+    {
+      insert(first->first);
+    }
+  }
+}
+#endif
@@ -18,9 +18,13 @@ namespace
   struct PrintWordPos
   {
     std::ostream & out;
+    const std::vector< size_t > & lines;
     void operator()(const std::pair< size_t, size_t > & pos) const
     {
-      out << " (" << pos.first << ", " << pos.second << ')';
+      if (lines[pos.first] != 0)
+      {
+        out << " (" << lines[pos.first] << ", " << pos.second << ')';
+      }
     }
   };
 
@@ -28,19 +32,15 @@ namespace
   {
     std::ostream & out;
     size_t width;
+    const std::vector< size_t > & lines;
     void operator()(constWord & word) const
     {
       out << std::left << std::setw(width) << word.first;
-      std::for_each(word.second.cbegin(), word.second.cend(), PrintWordPos{out});
+      std::for_each(word.second.cbegin(), word.second.cend(), PrintWordPos{out, lines});
       out << '\n';
     }
   };
 
-  std::pair< mozhegova::WordPos, std::string > createWordPair(const mozhegova::WordPos & pos, const std::string & word)
-  {
-    return std::make_pair(pos, word);
-  }
-
   struct Accumulator
   {
     std::string result;
@@ -74,19 +74,26 @@ namespace
     return acc;
   }
 
-  void supRecText(constWord & word, std::vector< std::pair< mozhegova::WordPos, std::string > > & sortedWords)
+  void supRecText(constWord & word, std::vector< std::pair< mozhegova::WordPos, std::string > > & sortedWords,
+      const std::vector< size_t > & lines)
   {
-    auto b = word.second.begin();
-    auto e = word.second.end();
-    using namespace std::placeholders;
-    std::transform(b, e, std::back_inserter(sortedWords), std::bind(createWordPair, _1, word.first));
+    for (auto it = word.second.cbegin(); it != word.second.cend(); ++it)
+    {
+      if (lines[it->first] != 0)
+      {
+        sortedWords.push_back({{lines[it->first], it->second}, word.first});
+      }
+    }
   }
 
   std::string reconstructText(const mozhegova::Text & text)
   {
     std::vector< std::pair< mozhegova::WordPos, std::string > > sortedWords;
+    std::vector< size_t > lines = text.lines.resolve();
     using namespace std::placeholders;
-    std::for_each(text.cbegin(), text.cend(), std::bind(supRecText, _1, std::ref(sortedWords)));
+    auto b = text.words.cbegin();
+    auto e = text.words.cend();
+    std::for_each(b, e, std::bind(supRecText, _1, std::ref(sortedWords), std::cref(lines)));
     std::sort(sortedWords.begin(), sortedWords.end());
     if (sortedWords.empty())
     {
@@ -97,51 +104,20 @@ namespace
     return result.result;
   }
 
-  size_t getSizeWord(constWord & word)
-  {
-    return word.second.size();
-  }
-
-  struct AccumulateTextSize
-  {
-    size_t operator()(size_t currentSize, constWord & word) const
-    {
-      return currentSize + getSizeWord(word);
-    }
-  };
-
   struct PrintText
   {
     std::ostream & out;
-    void operator()(const std::pair< std::string, mozhegova::Text > & text) const
+    void operator()(const std::pair< const std::string, mozhegova::Text > & text) const
     {
       out << text.first << ' ';
-      out << std::accumulate(text.second.cbegin(), text.second.cend(), 0, AccumulateTextSize()) << '\n';
+      out << text.second.lines.words() << '\n';
       out << reconstructText(text.second) << '\n';
     }
   };
 
-  bool cmpMaxLineNumWord(const std::pair< size_t, size_t > & a, const std::pair< size_t, size_t > & b)
-  {
-    return a.first < b.first;
-  }
-
-  size_t getMaxLineNumWord(constWord & word)
-  {
-    mozhegova::Xrefs xrefs = word.second;
-    if (xrefs.empty())
-    {
-      return 0;
-    }
-    auto maxNumIt = std::max_element(xrefs.cbegin(), xrefs.cend(), cmpMaxLineNumWord);
-    return maxNumIt->first;
-  }
-
   size_t getMaxLineNum(const mozhegova::Text & text)
   {
-    std::vector< size_t > lineNum;
-    std::transform(text.cbegin(), text.cend(), std::back_inserter(lineNum), getMaxLineNumWord);
-    return *std::max_element(lineNum.cbegin(), lineNum.cend());
+    return text.lines.maxLine();
   }
 
   bool cmpMaxNumWord(const std::pair< size_t, size_t > & a, const std::pair< size_t, size_t > & b)
@@ -163,7 +139,7 @@ namespace
   size_t getMaxNum(const mozhegova::Text & text)
   {
     std::vector< size_t > num;
-    std::transform(text.cbegin(), text.cend(), std::back_inserter(num), getMaxNumWord);
+    std::transform(text.words.cbegin(), text.words.cend(), std::back_inserter(num), getMaxNumWord);
     return *std::max_element(num.cbegin(), num.cend());
   }
 
@@ -172,7 +148,7 @@ namespace
     return pos.first >= begin && pos.first < end;
   }
 
-  void subExtrSubstr(constWord & word, mozhegova::Text & result, size_t begin, size_t end)
+  void subExtrSubstr(constWord & word, mozhegova::Words & result, size_t begin, size_t end)
   {
     mozhegova::Xrefs newXrefs;
     auto b = word.second.begin();
@@ -185,37 +161,14 @@ namespace
     }
   }
 
-  mozhegova::Text extractSubstring(const mozhegova::Text & text, size_t begin, size_t end)
+  mozhegova::Words extractSubstring(const mozhegova::Words & text, size_t begin, size_t end)
   {
-    mozhegova::Text result;
+    mozhegova::Words result;
     using namespace std::placeholders;
     std::for_each(text.cbegin(), text.cend(), std::bind(subExtrSubstr, _1, std::ref(result), begin, end));
     return result;
   }
 
-  mozhegova::WordPos downLenNum(const mozhegova::WordPos & pos, size_t begin, size_t end)
-  {
-    if (pos.first >= end)
-    {
-      return {pos.first - (end - begin), pos.second};
-    }
-    return pos;
-  }
-
-  mozhegova::WordPos uppLenNum(const mozhegova::WordPos & pos, size_t n, size_t add)
-  {
-    if (pos.first >= n)
-    {
-      return {pos.first + add, pos.second};
-    }
-    return pos;
-  }
-
-  mozhegova::WordPos changeLenNum(const mozhegova::WordPos & pos, size_t n, size_t begin)
-  {
-    return {pos.first + n - begin, pos.second};
-  }
-
   mozhegova::WordPos reverseLenNum(const mozhegova::WordPos & pos, size_t maxLine)
   {
     return {maxLine - pos.first + 1, pos.second};
@@ -235,50 +188,57 @@ namespace
     return {pos.first, pos.second + n};
   }
 
-  void subRemoveSubstr(Word & word, size_t begin, size_t end)
-  {
-    using namespace std::placeholders;
-    auto iter = std::remove_if(word.second.begin(), word.second.end(), std::bind(cmpBetween, _1, begin, end));
-    word.second.erase(iter, word.second.end());
-  }
-
-  void subDownLenNum(Word & word, size_t begin, size_t end)
-  {
-    auto b = word.second.begin();
-    auto e = word.second.end();
-    using namespace std::placeholders;
-    std::transform(b, e, b, std::bind(downLenNum, _1, begin, end));
-  }
-
+  // Removed lines only leave the table; their links are dropped once they outnumber the rest.
   void removeSubstring(mozhegova::Text & text, size_t begin, size_t end)
   {
-    using namespace std::placeholders;
-    std::for_each(text.begin(), text.end(), std::bind(subRemoveSubstr, _1, begin, end));
-    std::for_each(text.begin(), text.end(), std::bind(subDownLenNum, _1, begin, end));
-  }
-
-  void subUppLenNum(Word & word, size_t n, size_t begin, size_t end)
-  {
-    auto b = word.second.begin();
-    auto e = word.second.end();
-    using namespace std::placeholders;
-    std::transform(b, e, b, std::bind(uppLenNum, _1, n, end - begin));
-  }
-
-  void subChangeLenNum(Word & word, mozhegova::Text & text1, size_t n, size_t begin)
-  {
-    auto b = word.second.begin();
-    auto e = word.second.end();
-    using namespace std::placeholders;
-    std::transform(b, e, std::back_inserter(text1[word.first]), std::bind(changeLenNum, _1, n, begin));
+    text.lines.erase(begin, end);
+    if (text.lines.erasedWords() > text.lines.words())
+    {
+      mozhegova::settle(text);
+    }
   }
 
+  // Lines begin..end - 1 of text2 become new lines of text1 before line n; the links of text1 stay as they are.
   void insertTextTo(mozhegova::Text & text1, const mozhegova::Text & text2, size_t n, size_t begin, size_t end)
   {
-    mozhegova::Text temp = extractSubstring(text2, begin, end);
-    using namespace std::placeholders;
-    std::for_each(text1.begin(), text1.end(), std::bind(subUppLenNum, _1, n, begin, end));
-    std::for_each(text1.begin(), text1.end(), std::bind(subChangeLenNum, _1, std::ref(text1), n, begin));
+    // Words in the order they first appear, each with (index of its link, offset of the line); sorted by the index,
+    // the links keep the order they have in text2.
+    std::vector< size_t > ids = text2.lines.ids(begin, end);
+    std::unordered_map< const std::string *, size_t > groups;
+    std::vector< std::pair< const std::string *, std::vector< std::pair< size_t, size_t > > > > found;
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      const std::vector< mozhegova::LineTable::Entry > & words = text2.lines.wordsOn(ids[i]);
+      for (auto it = words.cbegin(); it != words.cend(); ++it)
+      {
+        auto group = groups.emplace(it->first, found.size()).first;
+        if (group->second == found.size())
+        {
+          found.push_back({it->first, {}});
+        }
+        found[group->second].second.push_back({it->second, i});
+      }
+    }
+    for (auto it = found.begin(); it != found.end(); ++it)
+    {
+      std::sort(it->second.begin(), it->second.end());
+      const mozhegova::Xrefs & source = text2.words.find(*it->first)->second;
+      for (auto pos = it->second.begin(); pos != it->second.end(); ++pos)
+      {
+        *pos = {pos->second, source[pos->first].second};
+      }
+    }
+    size_t first = text1.lines.insert(n, end - begin);
+    for (auto it = found.cbegin(); it != found.cend(); ++it)
+    {
+      auto wordIt = text1.words.emplace(*it->first, mozhegova::Xrefs()).first;
+      mozhegova::Xrefs & xrefs = wordIt->second;
+      for (auto pos = it->second.cbegin(); pos != it->second.cend(); ++pos)
+      {
+        text1.lines.addWord(first + pos->first, &wordIt->first, xrefs.size());
+        xrefs.push_back({first + pos->first, pos->second});
+      }
+    }
   }
 
   bool isWordOnLine(const mozhegova::WordPos & pos, size_t line)
@@ -286,7 +246,7 @@ namespace
     return pos.first == line;
   }
 
-  void subSideMerge(Word & word, size_t line, size_t num, mozhegova::Text & combinedText)
+  void subSideMerge(Word & word, size_t line, size_t num, mozhegova::Words & combinedText)
   {
     auto b = word.second.begin();
     auto e = word.second.end();
@@ -335,10 +295,12 @@ void mozhegova::generateLinks(std::istream & in, Texts & texts)
     while (file.peek() != '\n' && file >> word)
     {
       ++num;
-      text[word].push_back({line, num});
+      text.words[word].push_back({line, num});
     }
     file.ignore();
   }
+  text.lines = LineTable(line);
+  settle(text);
   texts[textName] = std::move(text);
 }
 
@@ -363,9 +325,10 @@ void mozhegova::printLinks(std::istream & in, std::ostream & out, const Texts &
     throw std::runtime_error("<INVALID COMMAND>");
   }
   const Text & text = it->second;
-  auto maxWordIt = std::max_element(text.cbegin(), text.cend(), cmpMaxWordLen);
+  std::vector< size_t > lines = text.lines.resolve();
+  auto maxWordIt = std::max_element(text.words.cbegin(), text.words.cend(), cmpMaxWordLen);
   size_t maxWordLen = maxWordIt->first.length() + 2;
-  std::for_each(text.cbegin(), text.cend(), PrintWords{out, maxWordLen});
+  std::for_each(text.words.cbegin(), text.words.cend(), PrintWords{out, maxWordLen, lines});
 }
 
 void mozhegova::printText(std::istream & in, std::ostream & out, const Texts & texts)
@@ -408,6 +371,7 @@ void mozhegova::mergeTexts(std::istream & in, Texts & texts)
   const Text & text1 = it1->second;
   const Text & text2 = it2->second;
   Text temp = text1;
+  settle(temp);
   size_t num = getMaxLineNum(temp) + 1;
   insertTextTo(temp, text2, num, 1, getMaxLineNum(text2) + 1);
   texts[newText] = std::move(temp);
@@ -426,7 +390,7 @@ void mozhegova::insertText(std::istream & in, Texts & texts)
   }
   Text & text1 = it1->second;
   const Text & text2 = it2->second;
-  if ((num > 1 + getMaxLineNum(text1)) || (begin < 1) || (end > getMaxLineNum(text2) + 1))
+  if ((num < 1) || (num > 1 + getMaxLineNum(text1)) || (begin < 1) || (begin > end) || (end > getMaxLineNum(text2) + 1))
   {
     throw std::runtime_error("<INVALID COMMAND>");
   }
@@ -444,7 +408,7 @@ void mozhegova::removeLines(std::istream & in, Texts & texts)
     throw std::runtime_error("<INVALID COMMAND>");
   }
   Text & text = it->second;
-  if ((begin < 1) || (end > getMaxLineNum(text) + 1))
+  if ((begin < 1) || (begin > end) || (end > getMaxLineNum(text) + 1))
   {
     throw std::runtime_error("<INVALID COMMAND>");
   }
@@ -464,7 +428,7 @@ void mozhegova::moveText(std::istream & in, Texts & texts)
   }
   Text & text1 = it1->second;
   Text & text2 = it2->second;
-  if ((num > 1 + getMaxLineNum(text1)) || (begin < 1) || (end > getMaxLineNum(text2) + 1))
+  if ((num < 1) || (num > 1 + getMaxLineNum(text1)) || (begin < 1) || (begin > end) || (end > getMaxLineNum(text2) + 1))
   {
     throw std::runtime_error("<INVALID COMMAND>");
   }
@@ -487,13 +451,19 @@ void mozhegova::sideMergeTexts(std::istream & in, Texts & texts)
   const Text & text2 = it2->second;
   Text temp1 = text1;
   Text temp2 = text2;
-  size_t maxLines = std::max(getMaxLineNum(text1), getMaxLineNum(text2));
-  size_t maxNum = getMaxNum(text1);
+  settle(temp1);
+  settle(temp2);
+  size_t maxLines = std::max(getMaxLineNum(temp1), getMaxLineNum(temp2));
+  size_t maxNum = getMaxNum(temp1);
   for (size_t line = 1; line <= maxLines; ++line)
   {
     using namespace std::placeholders;
-    std::for_each(temp2.begin(), temp2.end(), std::bind(subSideMerge, _1, line, maxNum, std::ref(temp1)));
+    auto b = temp2.words.begin();
+    auto e = temp2.words.end();
+    std::for_each(b, e, std::bind(subSideMerge, _1, line, maxNum, std::ref(temp1.words)));
   }
+  temp1.lines = LineTable(std::max(temp1.lines.size(), temp2.lines.size()));
+  settle(temp1);
   texts[newText] = std::move(temp1);
 }
 
@@ -513,7 +483,9 @@ void mozhegova::splitTexts(std::istream & in, Texts & texts)
   {
     throw std::runtime_error("<INVALID COMMAND>");
   }
-  Text newText = extractSubstring(text, num, end + 1);
+  settle(text);
+  Text newText{extractSubstring(text.words, num, end + 1), LineTable(end)};
+  settle(newText);
   removeSubstring(text, num, end + 1);
   texts[newText1] = std::move(text);
   texts[newText2] = std::move(newText);
@@ -530,9 +502,11 @@ void mozhegova::invertLines(std::istream & in, Texts & texts)
     throw std::runtime_error("<INVALID COMMAND>");
   }
   Text & text = it->second;
+  settle(text);
   size_t maxLine = getMaxLineNum(text);
   using namespace std::placeholders;
-  std::for_each(text.begin(), text.end(), std::bind(subInvertLines, _1, maxLine));
+  std::for_each(text.words.begin(), text.words.end(), std::bind(subInvertLines, _1, maxLine));
+  settle(text);
 }
 
 void mozhegova::invertWords(std::istream & in, Texts & texts)
@@ -545,12 +519,13 @@ void mozhegova::invertWords(std::istream & in, Texts & texts)
     throw std::runtime_error("<INVALID COMMAND>");
   }
   Text & text = it->second;
+  settle(text);
   size_t maxLines = getMaxLineNum(text);
   size_t maxNum = getMaxNum(text);
   for (size_t line = 1; line <= maxLines; ++line)
   {
     using namespace std::placeholders;
-    std::for_each(text.begin(), text.end(), std::bind(subInvertWords, _1, line, maxNum));
+    std::for_each(text.words.begin(), text.words.end(), std::bind(subInvertWords, _1, line, maxNum));
   }
 }
 
@@ -564,13 +539,25 @@ void mozhegova::replaceWord(std::istream & in, Texts & texts)
     throw std::runtime_error("<INVALID COMMAND>");
   }
   Text & text = it->second;
-  auto wordIt = text.find(oldWord);
-  if (wordIt == text.end())
+  if (text.words.find(oldWord) == text.words.end())
   {
     throw std::runtime_error("<INVALID COMMAND>");
   }
-  text[newWord] = std::move(wordIt->second);
-  text.erase(wordIt);
+  bool overwrites = text.words.find(newWord) != text.words.end();
+  auto newIt = text.words.emplace(newWord, Xrefs()).first;
+  auto wordIt = text.words.find(oldWord);
+  newIt->second = std::move(wordIt->second);
+  if (overwrites)
+  {
+    text.words.erase(wordIt);
+    settle(text);
+    return;
+  }
+  for (size_t i = 0; i < newIt->second.size(); ++i)
+  {
+    text.lines.renameWord(newIt->second[i].first, i, &wordIt->first, &newIt->first);
+  }
+  text.words.erase(wordIt);
 }
 
 void mozhegova::save(std::istream & in, const Texts & texts)
@@ -608,6 +595,7 @@ void mozhegova::loadFile(const std::string & fileName, Texts & texts)
     size_t wordCount;
     file >> textName >> wordCount;
     Text & currText = texts[textName];
+    settle(currText);
     std::string word;
     size_t line = 0;
     size_t j = 0;
@@ -618,12 +606,48 @@ void mozhegova::loadFile(const std::string & fileName, Texts & texts)
       while (file.peek() != '\n' && file >> word)
       {
         ++num;
-        currText[word].push_back({line, num});
+        currText.words[word].push_back({line, num});
         ++j;
       }
       file.ignore();
     }
+    currText.lines = LineTable(std::max(currText.lines.size(), line));
+    settle(currText);
+  }
+}
+
+void mozhegova::settle(Text & text)
+{
+  std::vector< size_t > lines = text.lines.resolve();
+  std::vector< size_t > counts(text.lines.size() + 1, 0);
+  for (auto it = text.words.cbegin(); it != text.words.cend(); ++it)
+  {
+    for (auto pos = it->second.cbegin(); pos != it->second.cend(); ++pos)
+    {
+      ++counts[lines[pos->first]];
+    }
+  }
+  LineTable settled(text.lines.size());
+  for (size_t line = 1; line < counts.size(); ++line)
+  {
+    settled.reserve(line, counts[line]);
+  }
+  for (auto it = text.words.begin(); it != text.words.end(); ++it)
+  {
+    Xrefs & xrefs = it->second;
+    auto kept = xrefs.begin();
+    for (auto pos = xrefs.cbegin(); pos != xrefs.cend(); ++pos)
+    {
+      size_t line = lines[pos->first];
+      if (line != 0)
+      {
+        settled.addWord(line, &it->first, kept - xrefs.begin());
+        *kept++ = {line, pos->second};
+      }
+    }
+    xrefs.erase(kept, xrefs.end());
   }
+  text.lines = std::move(settled);
 }
 
 void mozhegova::printHelp(std::ostream & out)
@@ -643,6 +667,8 @@ void mozhegova::printHelp(std::ostream & out)
   out << "invertlines <text name> - reverse the order of lines in the text\n";
   out << "invertwords <text name> - reverse the order of words in each line in the text\n";
   out << "replaceword <text name> <old word> <new word> - replace a word in the text with a new one \n";
+  out << "query <text name> <limit> <query> - lines matching words, \"phrases\", AND, OR, NOT and ( ),";
+  out << " first <limit> of them (0 - all)\n";
   out << "save <file name> - save all texts\n";
   out << "loadfile <file name> - load the file\n";
   out << "--continue - load the saves\n";
@@ -4,14 +4,25 @@
 #include <iostream>
 #include <unordered_map>
 #include <vector>
+#include "lines.hpp"
 
 namespace mozhegova
 {
+  // A word's position: the id of its line in the text's line table and its number on the line.
   using WordPos = std::pair< size_t, size_t >;
   using Xrefs = std::vector< WordPos >;
-  using Text = std::unordered_map< std::string, Xrefs >;
+  using Words = std::unordered_map< std::string, Xrefs >;
+  // The line table points at the keys of words: a copy has to be settled before it is edited.
+  struct Text
+  {
+    Words words;
+    LineTable lines;
+  };
   using Texts = std::unordered_map< std::string, Text >;
 
+  // Rewrites the links to line numbers, drops the removed ones and starts a plain line table.
+  void settle(Text & text);
+
   void generateLinks(std::istream & in, Texts & texts);
   void removeLinks(std::istream & in, Texts & texts);
   void printLinks(std::istream & in, std::ostream & out, const Texts & texts);
@@ -0,0 +1,180 @@
+#include "lines.hpp"
+#include <algorithm>
+
+mozhegova::LineTable::LineTable():
+  LineTable(0)
+{}
+
+mozhegova::LineTable::LineTable(size_t count):
+  runs_(),
+  content_(count + 1),
+  size_(count),
+  words_(0),
+  stored_(0)
+{
+  if (count != 0)
+  {
+    runs_.push_back({1, count});
+  }
+}
+
+size_t mozhegova::LineTable::size() const
+{
+  return size_;
+}
+
+size_t mozhegova::LineTable::maxLine() const
+{
+  size_t line = size_;
+  for (auto it = runs_.crbegin(); it != runs_.crend(); ++it)
+  {
+    for (size_t i = it->length; i > 0; --i, --line)
+    {
+      if (!content_[it->firstId + i - 1].empty())
+      {
+        return line;
+      }
+    }
+  }
+  return 0;
+}
+
+size_t mozhegova::LineTable::words() const
+{
+  return words_;
+}
+
+size_t mozhegova::LineTable::erasedWords() const
+{
+  return stored_ - words_;
+}
+
+size_t mozhegova::LineTable::insert(size_t line, size_t count)
+{
+  size_t first = content_.size();
+  if (count == 0)
+  {
+    return first;
+  }
+  content_.resize(first + count);
+  size_t start = 1;
+  auto it = runs_.begin();
+  while (it != runs_.end() && start + it->length <= line)
+  {
+    start += it->length;
+    ++it;
+  }
+  if (it != runs_.end() && start < line)
+  {
+    size_t head = line - start;
+    Run tail{it->firstId + head, it->length - head};
+    it->length = head;
+    it = runs_.insert(it + 1, tail);
+  }
+  if (it != runs_.begin() && (it - 1)->firstId + (it - 1)->length == first)
+  {
+    (it - 1)->length += count;
+  }
+  else
+  {
+    runs_.insert(it, Run{first, count});
+  }
+  size_ += count;
+  return first;
+}
+
+void mozhegova::LineTable::erase(size_t begin, size_t end)
+{
+  begin = std::max< size_t >(begin, 1);
+  end = std::min(end, size_ + 1);
+  if (begin >= end)
+  {
+    return;
+  }
+  std::vector< Run > kept;
+  size_t start = 1;
+  for (auto it = runs_.cbegin(); it != runs_.cend(); ++it)
+  {
+    size_t runEnd = start + it->length;
+    size_t cutBegin = std::max(begin, start);
+    size_t cutEnd = std::min(end, runEnd);
+    if (cutBegin >= cutEnd)
+    {
+      kept.push_back(*it);
+    }
+    else
+    {
+      if (cutBegin > start)
+      {
+        kept.push_back({it->firstId, cutBegin - start});
+      }
+      for (size_t id = it->firstId + cutBegin - start; id < it->firstId + cutEnd - start; ++id)
+      {
+        words_ -= content_[id].size();
+        std::vector< Entry >().swap(content_[id]);
+      }
+      if (cutEnd < runEnd)
+      {
+        kept.push_back({it->firstId + cutEnd - start, runEnd - cutEnd});
+      }
+    }
+    start = runEnd;
+  }
+  runs_.swap(kept);
+  size_ -= end - begin;
+}
+
+void mozhegova::LineTable::reserve(size_t id, size_t words)
+{
+  content_[id].reserve(words);
+}
+
+void mozhegova::LineTable::addWord(size_t id, const std::string * word, size_t index)
+{
+  content_[id].push_back({word, index});
+  ++words_;
+  ++stored_;
+}
+
+void mozhegova::LineTable::renameWord(size_t id, size_t index, const std::string * from, const std::string * to)
+{
+  auto it = std::find(content_[id].begin(), content_[id].end(), Entry{from, index});
+  if (it != content_[id].end())
+  {
+    it->first = to;
+  }
+}
+
+std::vector< size_t > mozhegova::LineTable::ids(size_t begin, size_t end) const
+{
+  std::vector< size_t > result;
+  size_t start = 1;
+  for (auto it = runs_.cbegin(); it != runs_.cend() && start < end; ++it)
+  {
+    for (size_t line = std::max(begin, start); line < std::min(end, start + it->length); ++line)
+    {
+      result.push_back(it->firstId + line - start);
+    }
+    start += it->length;
+  }
+  return result;
+}
+
+const std::vector< mozhegova::LineTable::Entry > & mozhegova::LineTable::wordsOn(size_t id) const
+{
+  return content_[id];
+}
+
+std::vector< size_t > mozhegova::LineTable::resolve() const
+{
+  std::vector< size_t > lines(content_.size(), 0);
+  size_t line = 1;
+  for (auto it = runs_.cbegin(); it != runs_.cend(); ++it)
+  {
+    for (size_t i = 0; i < it->length; ++i)
+    {
+      lines[it->firstId + i] = line++;
+    }
+  }
+  return lines;
+}
@@ -0,0 +1,59 @@
+#ifndef LINES_HPP
+#define LINES_HPP
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mozhegova
+{
+  // Lines of a text as runs of line ids. Links store ids instead of line numbers, so inserting or removing
+  // lines only splits runs; the numbers are worked out when the text is printed.
+  // Every line also lists its words, so a range of lines is read without going through all the links.
+  class LineTable
+  {
+  public:
+    // A word on a line: its key in the text and the index of the link among the word's links.
+    using Entry = std::pair< const std::string *, size_t >;
+
+    LineTable();
+    // Lines 1..count with ids equal to their numbers.
+    explicit LineTable(size_t count);
+
+    size_t size() const;
+    // Last line holding a word, 0 if there is none.
+    size_t maxLine() const;
+    size_t words() const;
+    size_t erasedWords() const;
+
+    // Adds count empty lines before the given one and returns the id of the first of them; the ids are consecutive.
+    size_t insert(size_t line, size_t count);
+    // Removes lines begin..end - 1.
+    void erase(size_t begin, size_t end);
+    void reserve(size_t id, size_t words);
+    void addWord(size_t id, const std::string * word, size_t index);
+    void renameWord(size_t id, size_t index, const std::string * from, const std::string * to);
+
+    // Ids of lines begin..end - 1 in order.
+    std::vector< size_t > ids(size_t begin, size_t end) const;
+    const std::vector< Entry > & wordsOn(size_t id) const;
+    // Line number of every id, 0 for removed ones.
+    std::vector< size_t > resolve() const;
+
+  private:
+    struct Run
+    {
+      size_t firstId;
+      size_t length;
+    };
+
+    std::vector< Run > runs_;
+    std::vector< std::vector< Entry > > content_;
+    size_t size_;
+    size_t words_;
+    size_t stored_;
+  };
+}
+
+#endif
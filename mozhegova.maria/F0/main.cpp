@@ -1,4 +1,5 @@
 #include <map>
+#include <set>
 #include <vector>
 #include <iostream>
 #include <fstream>
@@ -7,11 +8,12 @@
 #include <algorithm>
 #include <functional>
 #include "commands.hpp"
+#include "query.hpp"
 
 int main(int argc, char * argv[])
 {
   using namespace mozhegova;
-  std::unordered_map< std::string, std::unordered_map< std::string, std::vector< std::pair< size_t, size_t > > > > texts;
+  Texts texts;
   if (argc == 2 && std::string(argv[1]) == "--help")
   {
     printHelp(std::cout);
@@ -30,6 +32,9 @@ int main(int argc, char * argv[])
     }
   }
 
+  QueryIndexes queryIndexes;
+  std::set< std::string > readOnlyCmds = {"printlinks", "printtext", "printtextinfile", "save", "query"};
+
   std::map< std::string, std::function< void() > > cmds;
   cmds["generatelinks"] = std::bind(generateLinks, std::ref(std::cin), std::ref(texts));
   cmds["removelinks"] = std::bind(removeLinks, std::ref(std::cin), std::ref(texts));
@@ -45,6 +50,7 @@ int main(int argc, char * argv[])
   cmds["invertlines"] = std::bind(invertLines, std::ref(std::cin), std::ref(texts));
   cmds["invertwords"] = std::bind(invertWords, std::ref(std::cin), std::ref(texts));
   cmds["replaceword"] = std::bind(replaceWord, std::ref(std::cin), std::ref(texts));
+  cmds["query"] = std::bind(query, std::ref(std::cin), std::ref(std::cout), std::ref(texts), std::ref(queryIndexes));
   cmds["save"] = std::bind(save, std::ref(std::cin), std::cref(texts));
   cmds["loadfile"] = std::bind(loadFileCmd, std::ref(std::cin), std::ref(texts));
 
@@ -53,6 +59,10 @@ int main(int argc, char * argv[])
   {
     try
     {
+      if (readOnlyCmds.find(command) == readOnlyCmds.end())
+      {
+        queryIndexes.clear();
+      }
       cmds.at(command)();
     }
     catch (...)
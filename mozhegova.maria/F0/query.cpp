@@ -0,0 +1,473 @@
+#include "query.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+  const size_t NO_LINE = std::numeric_limits< size_t >::max();
+
+  // First index not before from whose position is not less than target: doubling steps, then a binary search.
+  size_t gallop(const mozhegova::Xrefs & xrefs, size_t from, const mozhegova::WordPos & target)
+  {
+    size_t low = from;
+    size_t high = from;
+    size_t step = 1;
+    while (high < xrefs.size() && xrefs[high] < target)
+    {
+      low = high + 1;
+      high += step;
+      step *= 2;
+    }
+    high = std::min(high, xrefs.size());
+    return std::lower_bound(xrefs.begin() + low, xrefs.begin() + high, target) - xrefs.begin();
+  }
+
+  // Walks the matching lines of a subquery; the lines asked for never decrease.
+  // The last answer is kept: a parent may ask again for a line a child has already looked past.
+  struct Cursor
+  {
+    size_t found = 0;
+
+    virtual ~Cursor() = default;
+    virtual size_t seek(size_t line) = 0;
+
+    size_t next(size_t line)
+    {
+      if (line > found)
+      {
+        found = seek(line);
+      }
+      return found;
+    }
+  };
+  using CursorPtr = std::unique_ptr< Cursor >;
+
+  struct WordCursor: Cursor
+  {
+    const mozhegova::Xrefs & xrefs;
+    size_t pos;
+
+    explicit WordCursor(const mozhegova::Xrefs & words):
+      xrefs(words),
+      pos(0)
+    {}
+
+    size_t seek(size_t line) override
+    {
+      pos = gallop(xrefs, pos, {line, 0});
+      return pos < xrefs.size() ? xrefs[pos].first : NO_LINE;
+    }
+  };
+
+  // Candidates come from the rarest word of the phrase; the others are galloped to the numbers next to it.
+  struct PhraseCursor: Cursor
+  {
+    std::vector< const mozhegova::Xrefs * > words;
+    std::vector< size_t > pos;
+    size_t pivot;
+
+    explicit PhraseCursor(const std::vector< const mozhegova::Xrefs * > & phrase):
+      words(phrase),
+      pos(phrase.size(), 0),
+      pivot(0)
+    {
+      for (size_t i = 1; i < words.size(); ++i)
+      {
+        if (words[i]->size() < words[pivot]->size())
+        {
+          pivot = i;
+        }
+      }
+    }
+
+    size_t seek(size_t line) override
+    {
+      const mozhegova::Xrefs & lead = *words[pivot];
+      for (pos[pivot] = gallop(lead, pos[pivot], {line, 0}); pos[pivot] < lead.size(); ++pos[pivot])
+      {
+        if (matchesAt(lead[pos[pivot]]))
+        {
+          return lead[pos[pivot]].first;
+        }
+      }
+      return NO_LINE;
+    }
+
+    bool matchesAt(const mozhegova::WordPos & candidate)
+    {
+      if (candidate.second <= pivot)
+      {
+        return false;
+      }
+      size_t start = candidate.second - pivot;
+      for (size_t i = 0; i < words.size(); ++i)
+      {
+        if (i == pivot)
+        {
+          continue;
+        }
+        mozhegova::WordPos target{candidate.first, start + i};
+        pos[i] = gallop(*words[i], pos[i], target);
+        if (pos[i] == words[i]->size() || (*words[i])[pos[i]] != target)
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+  };
+
+  // Leapfrogs the included cursors to a common line, then skips lines any excluded cursor matches.
+  struct AndCursor: Cursor
+  {
+    std::vector< CursorPtr > include;
+    std::vector< CursorPtr > exclude;
+
+    size_t seek(size_t line) override
+    {
+      for (size_t target = align(line); target != NO_LINE; target = align(target + 1))
+      {
+        if (!isExcluded(target))
+        {
+          return target;
+        }
+      }
+      return NO_LINE;
+    }
+
+    size_t align(size_t target)
+    {
+      size_t agreed = 0;
+      for (size_t i = 0; agreed < include.size(); i = (i + 1) % include.size())
+      {
+        size_t found = include[i]->next(target);
+        if (found == NO_LINE)
+        {
+          return NO_LINE;
+        }
+        agreed = (found == target) ? agreed + 1 : 1;
+        target = found;
+      }
+      return target;
+    }
+
+    bool isExcluded(size_t line)
+    {
+      for (size_t i = 0; i < exclude.size(); ++i)
+      {
+        if (exclude[i]->next(line) == line)
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+  };
+
+  struct OrCursor: Cursor
+  {
+    std::vector< CursorPtr > alternatives;
+
+    size_t seek(size_t line) override
+    {
+      size_t best = NO_LINE;
+      for (size_t i = 0; i < alternatives.size(); ++i)
+      {
+        best = std::min(best, alternatives[i]->next(line));
+      }
+      return best;
+    }
+  };
+
+  struct EveryLineCursor: Cursor
+  {
+    size_t last;
+
+    explicit EveryLineCursor(size_t maxLine):
+      last(maxLine)
+    {}
+
+    size_t seek(size_t line) override
+    {
+      return line <= last ? line : NO_LINE;
+    }
+  };
+
+  struct Token
+  {
+    enum Kind
+    {
+      WORD,
+      PHRASE,
+      OPEN,
+      CLOSE
+    };
+    Kind kind;
+    std::string text;
+  };
+
+  std::vector< Token > tokenize(const std::string & expression)
+  {
+    std::vector< Token > tokens;
+    size_t i = 0;
+    while (i < expression.size())
+    {
+      char c = expression[i];
+      if (std::isspace(static_cast< unsigned char >(c)))
+      {
+        ++i;
+      }
+      else if (c == '(' || c == ')')
+      {
+        tokens.push_back({c == '(' ? Token::OPEN : Token::CLOSE, std::string(1, c)});
+        ++i;
+      }
+      else if (c == '"')
+      {
+        size_t close = expression.find('"', i + 1);
+        if (close == std::string::npos)
+        {
+          throw std::runtime_error("<INVALID COMMAND>");
+        }
+        tokens.push_back({Token::PHRASE, expression.substr(i + 1, close - i - 1)});
+        i = close + 1;
+      }
+      else
+      {
+        size_t end = i;
+        while (end < expression.size() && !std::isspace(static_cast< unsigned char >(expression[end])) &&
+            expression[end] != '(' && expression[end] != ')' && expression[end] != '"')
+        {
+          ++end;
+        }
+        tokens.push_back({Token::WORD, expression.substr(i, end - i)});
+        i = end;
+      }
+    }
+    return tokens;
+  }
+
+  // expression: conjunction { OR conjunction }
+  // conjunction: factor { [AND] factor }
+  // factor: NOT factor | ( expression ) | "phrase" | word
+  class QueryParser
+  {
+  public:
+    QueryParser(const mozhegova::Text & text, const mozhegova::QueryIndex & index, const std::vector< Token > & tokens):
+      text_(text),
+      index_(index),
+      tokens_(tokens),
+      current_(0)
+    {}
+
+    CursorPtr parse()
+    {
+      CursorPtr result = expression();
+      if (current_ != tokens_.size())
+      {
+        throw std::runtime_error("<INVALID COMMAND>");
+      }
+      return result;
+    }
+
+  private:
+    const mozhegova::Text & text_;
+    const mozhegova::QueryIndex & index_;
+    std::vector< Token > tokens_;
+    size_t current_;
+
+    bool isKeyword(const char * keyword) const
+    {
+      return current_ < tokens_.size() && tokens_[current_].kind == Token::WORD && tokens_[current_].text == keyword;
+    }
+
+    bool isKind(Token::Kind kind) const
+    {
+      return current_ < tokens_.size() && tokens_[current_].kind == kind;
+    }
+
+    CursorPtr expression()
+    {
+      std::unique_ptr< OrCursor > result(new OrCursor);
+      result->alternatives.push_back(conjunction());
+      while (isKeyword("OR"))
+      {
+        ++current_;
+        result->alternatives.push_back(conjunction());
+      }
+      if (result->alternatives.size() == 1)
+      {
+        return std::move(result->alternatives.front());
+      }
+      return CursorPtr(std::move(result));
+    }
+
+    CursorPtr conjunction()
+    {
+      std::unique_ptr< AndCursor > result(new AndCursor);
+      while (true)
+      {
+        bool negated = false;
+        CursorPtr operand = factor(negated);
+        (negated ? result->exclude : result->include).push_back(std::move(operand));
+        if (current_ == tokens_.size() || isKind(Token::CLOSE) || isKeyword("OR"))
+        {
+          break;
+        }
+        if (isKeyword("AND"))
+        {
+          ++current_;
+        }
+      }
+      if (result->include.empty())
+      {
+        result->include.push_back(everyLine());
+      }
+      if (result->include.size() == 1 && result->exclude.empty())
+      {
+        return std::move(result->include.front());
+      }
+      return CursorPtr(std::move(result));
+    }
+
+    CursorPtr factor(bool & negated)
+    {
+      while (isKeyword("NOT"))
+      {
+        ++current_;
+        negated = !negated;
+      }
+      if (current_ == tokens_.size() || isKind(Token::CLOSE) || isKeyword("AND") || isKeyword("OR"))
+      {
+        throw std::runtime_error("<INVALID COMMAND>");
+      }
+      const Token & token = tokens_[current_++];
+      if (token.kind == Token::OPEN)
+      {
+        CursorPtr inner = expression();
+        if (!isKind(Token::CLOSE))
+        {
+          throw std::runtime_error("<INVALID COMMAND>");
+        }
+        ++current_;
+        return inner;
+      }
+      if (token.kind == Token::PHRASE)
+      {
+        return phrase(token.text);
+      }
+      return CursorPtr(new WordCursor(postings(token.text)));
+    }
+
+    CursorPtr phrase(const std::string & words)
+    {
+      std::istringstream in(words);
+      std::vector< const mozhegova::Xrefs * > phraseWords;
+      std::string word;
+      while (in >> word)
+      {
+        phraseWords.push_back(&postings(word));
+      }
+      if (phraseWords.empty())
+      {
+        throw std::runtime_error("<INVALID COMMAND>");
+      }
+      if (phraseWords.size() == 1)
+      {
+        return CursorPtr(new WordCursor(*phraseWords.front()));
+      }
+      return CursorPtr(new PhraseCursor(phraseWords));
+    }
+
+    CursorPtr everyLine() const
+    {
+      return CursorPtr(new EveryLineCursor(index_.lastLine));
+    }
+
+    const mozhegova::Xrefs & postings(const std::string & word) const
+    {
+      static const mozhegova::Xrefs none;
+      auto copy = index_.sorted.find(word);
+      if (copy != index_.sorted.end())
+      {
+        return copy->second;
+      }
+      auto it = text_.words.find(word);
+      return it == text_.words.end() ? none : it->second;
+    }
+  };
+}
+
+mozhegova::QueryIndex mozhegova::indexText(const Text & text)
+{
+  QueryIndex index{{}, 0};
+  for (auto it = text.words.cbegin(); it != text.words.cend(); ++it)
+  {
+    const Xrefs * xrefs = &it->second;
+    if (!std::is_sorted(xrefs->cbegin(), xrefs->cend()))
+    {
+      Xrefs & copy = index.sorted[it->first];
+      copy = *xrefs;
+      std::sort(copy.begin(), copy.end());
+      xrefs = &copy;
+    }
+    if (!xrefs->empty())
+    {
+      index.lastLine = std::max(index.lastLine, xrefs->back().first);
+    }
+  }
+  return index;
+}
+
+std::vector< size_t > mozhegova::findLines(const Text & text, const QueryIndex & index, const std::string & expression,
+    size_t limit)
+{
+  QueryParser parser(text, index, tokenize(expression));
+  CursorPtr root = parser.parse();
+  std::vector< size_t > lines;
+  for (size_t line = root->next(1); line != NO_LINE; line = root->next(line + 1))
+  {
+    lines.push_back(line);
+    if (lines.size() == limit)
+    {
+      break;
+    }
+  }
+  return lines;
+}
+
+void mozhegova::query(std::istream & in, std::ostream & out, Texts & texts, QueryIndexes & indexes)
+{
+  std::string textName;
+  size_t limit = 0;
+  in >> textName >> limit;
+  std::string expression;
+  while (in && in.peek() != '\n' && in.peek() != std::char_traits< char >::eof())
+  {
+    expression += static_cast< char >(in.get());
+  }
+  auto it = texts.find(textName);
+  if (!in || it == texts.end())
+  {
+    throw std::runtime_error("<INVALID COMMAND>");
+  }
+  auto indexIt = indexes.find(textName);
+  if (indexIt == indexes.end())
+  {
+    settle(it->second);
+    indexIt = indexes.emplace(textName, indexText(it->second)).first;
+  }
+  std::vector< size_t > lines = findLines(it->second, indexIt->second, expression, limit);
+  if (lines.empty())
+  {
+    out << "<EMPTY>\n";
+    return;
+  }
+  std::copy(lines.cbegin(), lines.cend() - 1, std::ostream_iterator< size_t >(out, " "));
+  out << lines.back() << '\n';
+}
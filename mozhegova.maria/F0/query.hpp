@@ -0,0 +1,30 @@
+#ifndef QUERY_HPP
+#define QUERY_HPP
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "commands.hpp"
+
+namespace mozhegova
+{
+  // What a query needs besides the text: sorted copies of the links an edit left out of order,
+  // and the last line holding a word. Valid until the text changes.
+  struct QueryIndex
+  {
+    std::unordered_map< std::string, Xrefs > sorted;
+    size_t lastLine;
+  };
+  using QueryIndexes = std::unordered_map< std::string, QueryIndex >;
+
+  // Both work on a settled text, whose links hold line numbers.
+  QueryIndex indexText(const Text & text);
+  // Lines of the text matching the expression, ascending; limit 0 returns all of them.
+  // Words and "quoted phrases" are combined with AND (or nothing), OR, NOT and parentheses.
+  std::vector< size_t > findLines(const Text & text, const QueryIndex & index, const std::string & expression,
+      size_t limit);
+  void query(std::istream & in, std::ostream & out, Texts & texts, QueryIndexes & indexes);
+}
+
+#endif
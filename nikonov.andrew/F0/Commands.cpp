@@ -7,6 +7,20 @@
 #include <iomanip>
 #include <sstream>
 
+namespace {
+  nikonov::str restoreContent(nikonov::Storage& storage, const nikonov::Text& text)
+  {
+    if (!text.isCompressed()) {
+      return text.getOriginalContent();
+    }
+    nikonov::Encoding* encoding = storage.getEncoding(text.getEncodingId());
+    if (encoding == nullptr) {
+      throw std::runtime_error("ERROR: Invalid encoding_id.");
+    }
+    return nikonov::HuffmanCore::decompress(text.getCompressedContent(), encoding->getReverseTable());
+  }
+}
+
 void nikonov::getCommands(std::map< str, std::function< void(Storage&, std::istream&, std::ostream&) > >& commands)
 {
   commands["compress_text"] = compressText;
@@ -35,11 +49,11 @@ void nikonov::compressText(Storage& storage, std::istream& in, std::ostream& out
     throw std::runtime_error("ERROR: Text already compressed.");
   }
   auto codes = HuffmanCore::buildCodes(text->getOriginalContent());
-  str compressed = HuffmanCore::compress(text->getOriginalContent(), codes);
+  PackedBits compressed = HuffmanCore::compress(text->getOriginalContent(), codes);
   if (!storage.addEncoding(newEncodingId, codes, textId)) {
     throw std::runtime_error("ERROR: Memory overflow.");
   }
-  if (!storage.addCompressedText(newTextId, text->getOriginalContent(), compressed, newEncodingId)) {
+  if (!storage.addCompressedText(newTextId, text->getOriginalContent().size(), compressed, newEncodingId)) {
     throw std::runtime_error("ERROR: Memory overflow.");
   }
   out << "Text compressed successfully. Encoding ID: " << newEncodingId << std::endl;
@@ -60,10 +74,7 @@ void nikonov::decompressText(Storage& storage, std::istream& in, std::ostream& o
   if (encoding == nullptr) {
     throw std::runtime_error("ERROR: Invalid encoding_id.");
   }
-  str decompressed = HuffmanCore::decompress(
-    text->getCompressedContent(), 
-    encoding->getReverseTable()
-  );
+  str decompressed = HuffmanCore::decompress(text->getCompressedContent(), encoding->getReverseTable());
   if (!storage.addText(newTextId, decompressed)) {
     throw std::runtime_error("ERROR: Memory overflow.");
   }
@@ -103,11 +114,11 @@ void nikonov::applyEncoding(Storage& storage, std::istream& in, std::ostream& ou
   if (encoding == nullptr) {
     throw std::runtime_error("ERROR: Invalid encoding_id.");
   }
-  str compressed = HuffmanCore::compress(
+  PackedBits compressed = HuffmanCore::compress(
     text->getOriginalContent(), 
     encoding->getCodeTable()
   );
-  if (!storage.addCompressedText(newTextId, text->getOriginalContent(), compressed, encodingId)) {
+  if (!storage.addCompressedText(newTextId, text->getOriginalContent().size(), compressed, encodingId)) {
     throw std::runtime_error("ERROR: Memory overflow.");
   }
   out << "Encoding applied successfully." << std::endl;
@@ -129,12 +140,12 @@ void nikonov::compareEncodings(Storage& storage, std::istream& in, std::ostream&
   if (encoding1 == nullptr || encoding2 == nullptr) {
     throw std::runtime_error("ERROR: Invalid encoding_id.");
   }
-  str compressed1 = HuffmanCore::compress(text->getOriginalContent(), encoding1->getCodeTable());
-  str compressed2 = HuffmanCore::compress(text->getOriginalContent(), encoding2->getCodeTable());
-  double ratio1 = static_cast<double>(compressed1.size()) / static_cast<double>(text->getOriginalSizeBits());
-  double ratio2 = static_cast<double>(compressed2.size()) / static_cast<double>(text->getOriginalSizeBits());
-  out << "Encoding 1: " << compressed1.size() << " bits, compression ratio: " << ratio1 << std::endl;
-  out << "Encoding 2: " << compressed2.size() << " bits, compression ratio: " << ratio2 << std::endl;
+  PackedBits compressed1 = HuffmanCore::compress(text->getOriginalContent(), encoding1->getCodeTable());
+  PackedBits compressed2 = HuffmanCore::compress(text->getOriginalContent(), encoding2->getCodeTable());
+  double ratio1 = static_cast<double>(compressed1.bitCount) / static_cast<double>(text->getOriginalSizeBits());
+  double ratio2 = static_cast<double>(compressed2.bitCount) / static_cast<double>(text->getOriginalSizeBits());
+  out << "Encoding 1: " << compressed1.bitCount << " bits, compression ratio: " << ratio1 << std::endl;
+  out << "Encoding 2: " << compressed2.bitCount << " bits, compression ratio: " << ratio2 << std::endl;
 }
 
 void nikonov::showEncoding(Storage& storage, std::istream& in, std::ostream& out)
@@ -160,7 +171,7 @@ void nikonov::textStats(Storage& storage, std::istream& in, std::ostream& out)
   if (text == nullptr) {
     throw std::runtime_error("ERROR: Invalid text_id.");
   }
-  str content = text->getOriginalContent();
+  str content = restoreContent(storage, *text);
   std::unordered_map< char, int > freq;
   for (char c : content) {
     freq[c]++;
@@ -185,11 +196,11 @@ void nikonov::testCompression(Storage& storage, std::istream& in, std::ostream&
     throw std::runtime_error("ERROR: Text already compressed.");
   }
   auto codes = HuffmanCore::buildCodes(text->getOriginalContent());
-  str compressed = HuffmanCore::compress(text->getOriginalContent(), codes);
+  PackedBits compressed = HuffmanCore::compress(text->getOriginalContent(), codes);
   str decompressed = HuffmanCore::decompress(compressed, Encoding(codes).getReverseTable());
-  double ratio = static_cast<double>(compressed.size()) / static_cast<double>(text->getOriginalSizeBits());
+  double ratio = static_cast<double>(compressed.bitCount) / static_cast<double>(text->getOriginalSizeBits());
   out << "Original size: " << text->getOriginalSizeBits() << " bits" << std::endl;
-  out << "Compressed size: " << compressed.size() << " bits" << std::endl;
+  out << "Compressed size: " << compressed.bitCount << " bits" << std::endl;
   out << "Compression ratio: " << ratio << std::endl;
   out << "Decompression successful: " << (decompressed == text->getOriginalContent() ? "Yes" : "No") << std::endl;
 }
@@ -240,7 +251,7 @@ void nikonov::uploadText(Storage& storage, std::istream& in, std::ostream& out)
   if (!file.is_open()) {
     throw std::runtime_error("ERROR: Writing has been denied.");
   }
-  file << text->getOriginalContent();
+  file << restoreContent(storage, *text);
   file.close();
   out << "Text uploaded to file successfully." << std::endl;
 }
@@ -1,11 +1,20 @@
 #include "DataStorage.hpp"
 #include <stdexcept>
 
-nikonov::Text::Text(const str& content, bool isCompressed, const str& encodingId, const str& compressedData):
+nikonov::Text::Text(const str& content):
   originalContent_(content),
+  compressedContent_{ {}, 0 },
+  originalSize_(content.size()),
+  encodingId_(),
+  isCompressed_(false)
+{}
+
+nikonov::Text::Text(const PackedBits& compressedData, size_t originalSize, const str& encodingId):
+  originalContent_(),
   compressedContent_(compressedData),
+  originalSize_(originalSize),
   encodingId_(encodingId),
-  isCompressed_(isCompressed)
+  isCompressed_(true)
 {}
 
 const std::string& nikonov::Text::getOriginalContent() const
@@ -13,7 +22,7 @@ const std::string& nikonov::Text::getOriginalContent() const
   return originalContent_;
 }
 
-const std::string& nikonov::Text::getCompressedContent() const
+const nikonov::PackedBits& nikonov::Text::getCompressedContent() const
 {
   return compressedContent_;
 }
@@ -31,12 +40,12 @@ bool nikonov::Text::isCompressed() const
 size_t nikonov::Text::getOriginalSizeBits() const
 {
   constexpr int sizeOfByte = 8;
-  return originalContent_.size() * sizeOfByte;
+  return originalSize_ * sizeOfByte;
 }
 
 size_t nikonov::Text::getCompressedSizeBits() const
 {
-  return compressedContent_.size();
+  return compressedContent_.bitCount;
 }
 
 nikonov::Encoding::Encoding(const std::unordered_map< char, str >& codeTable, const str& fromTextId):
@@ -77,12 +86,12 @@ bool nikonov::Storage::addText(const str& id, const str& content)
   return true;
 }
 
-bool nikonov::Storage::addCompressedText(const str& id, const str& original, const str& compressed, const str& encodingId)
+bool nikonov::Storage::addCompressedText(const str& id, size_t originalSize, const PackedBits& compressed, const str& encodingId)
 {
   if (texts_.find(id) != texts_.end()) {
     return false;
   }
-  texts_[id] = std::make_unique< Text >(original, true, encodingId, compressed);
+  texts_[id] = std::make_unique< Text >(compressed, originalSize, encodingId);
   return true;
 }
 
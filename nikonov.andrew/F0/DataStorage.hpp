@@ -3,21 +3,24 @@
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include "HuffmanCore.hpp"
 
 namespace nikonov {
   using str = std::string;
   class Text {
   public:
-    Text(const str& content, bool isCompressed = false, const str& encodingId = "", const str& compressedData = "");
+    explicit Text(const str& content);
+    Text(const PackedBits& compressedData, size_t originalSize, const str& encodingId);
     const str& getOriginalContent() const;
-    const str& getCompressedContent() const;
+    const PackedBits& getCompressedContent() const;
     const str& getEncodingId() const;
     bool isCompressed() const;
     size_t getOriginalSizeBits() const;
     size_t getCompressedSizeBits() const;
   private:
     str originalContent_;
-    str compressedContent_;
+    PackedBits compressedContent_;
+    size_t originalSize_;
     str encodingId_;
     bool isCompressed_;
   };
@@ -38,7 +41,7 @@ namespace nikonov {
   class Storage {
   public:
     bool addText(const str& id, const str& content);
-    bool addCompressedText(const str& id, const str& original, const str& compressed, const str& encodingId);
+    bool addCompressedText(const str& id, size_t originalSize, const PackedBits& compressed, const str& encodingId);
     Text* getText(const str& id);
     bool textExists(const str& id) const;
     bool addEncoding(const str& id, const std::unordered_map< char, str >& codes, const str& textId = "");
@@ -1,5 +1,35 @@
 #include "HuffmanCore.hpp"
+#include <algorithm>
+#include <array>
 #include <functional>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+  using CodeLength = std::pair< size_t, unsigned char >;
+
+  std::vector< nikonov::str > canonicalCodes(std::vector< CodeLength >& lengths)
+  {
+    std::sort(lengths.begin(), lengths.end());
+    std::vector< nikonov::str > codes;
+    nikonov::str code;
+    for (const CodeLength& length : lengths) {
+      if (!codes.empty()) {
+        size_t i = code.size();
+        while (i > 0 && code[i - 1] == '1') {
+          code[--i] = '0';
+        }
+        if (i == 0) {
+          return {};
+        }
+        code[i - 1] = '1';
+      }
+      code.resize(length.first, '0');
+      codes.push_back(code);
+    }
+    return codes;
+  }
+}
 
 nikonov::HuffmanNode::HuffmanNode(char c, int freq):
   character(c),
@@ -31,6 +61,18 @@ void nikonov::HuffmanCore::buildCodeTable(HuffmanNode* node, const str& code, st
   }
 }
 
+void nikonov::HuffmanCore::canonicalize(std::unordered_map< char, str >& codes)
+{
+  std::vector< CodeLength > lengths;
+  for (const auto& pair : codes) {
+    lengths.emplace_back(pair.second.size(), static_cast< unsigned char >(pair.first));
+  }
+  std::vector< str > canonical = canonicalCodes(lengths);
+  for (size_t i = 0; i < canonical.size(); ++i) {
+    codes[static_cast< char >(lengths[i].second)] = canonical[i];
+  }
+}
+
 std::unordered_map< char, std::string > nikonov::HuffmanCore::buildCodes(const str& text)
 {
   if (text.empty()) {
@@ -67,28 +109,183 @@ std::unordered_map< char, std::string > nikonov::HuffmanCore::buildCodes(const s
   }
 
   delete root;
+  canonicalize(codes);
   return codes;
 }
 
-std::string nikonov::HuffmanCore::compress(const str& text, const std::unordered_map< char, str >& codes)
+nikonov::PackedBits nikonov::HuffmanCore::compress(const str& text, const std::unordered_map< char, str >& codes)
 {
-  str compressed;
+  std::array< const str*, 256 > table{};
+  for (const auto& pair : codes) {
+    table[static_cast< unsigned char >(pair.first)] = std::addressof(pair.second);
+  }
+  PackedBits compressed{ {}, 0 };
   for (char c : text) {
-    compressed += codes.at(c);
+    const str* code = table[static_cast< unsigned char >(c)];
+    if (code == nullptr) {
+      throw std::out_of_range("No code for character");
+    }
+    for (char bit : *code) {
+      if (compressed.bitCount % 8 == 0) {
+        compressed.data.push_back(0);
+      }
+      if (bit == '1') {
+        compressed.data.back() |= static_cast< unsigned char >(0x80 >> (compressed.bitCount % 8));
+      }
+      ++compressed.bitCount;
+    }
   }
   return compressed;
 }
 
-std::string nikonov::HuffmanCore::decompress(const str& compressed, const std::unordered_map< str, char >& reverseCodes)
+std::string nikonov::HuffmanCore::decompress(const PackedBits& compressed, const std::unordered_map< str, char >& reverseCodes)
+{
+  return DecodeTable(reverseCodes).decode(compressed);
+}
+
+nikonov::DecodeTable::DecodeTable(const std::unordered_map< str, char >& reverseCodes):
+  trie_(1, TrieNode{ { -1, -1 }, false, '\0' }),
+  table_(),
+  lookupBits_(1),
+  canonical_(false),
+  firstCode_(),
+  firstIndex_(),
+  lengthCount_(),
+  sortedSymbols_()
+{
+  constexpr size_t maxLookupBits = 10;
+  constexpr size_t maxCanonicalBits = 63;
+  std::vector< CodeLength > lengths;
+  for (const auto& pair : reverseCodes) {
+    if (!pair.first.empty() && pair.first.find_first_not_of("01") == str::npos) {
+      insertCode(pair.first, pair.second);
+      lookupBits_ = std::max(lookupBits_, std::min(pair.first.size(), maxLookupBits));
+      lengths.emplace_back(pair.first.size(), static_cast< unsigned char >(pair.second));
+    }
+  }
+  std::vector< str > canonical = canonicalCodes(lengths);
+  canonical_ = !canonical.empty() && canonical.back().size() <= maxCanonicalBits;
+  for (size_t i = 0; canonical_ && i < canonical.size(); ++i) {
+    auto it = reverseCodes.find(canonical[i]);
+    canonical_ = it != reverseCodes.end() && static_cast< unsigned char >(it->second) == lengths[i].second;
+  }
+  if (canonical_) {
+    lengthCount_.resize(canonical.back().size() + 1, 0);
+    firstCode_.resize(lengthCount_.size(), 0);
+    firstIndex_.resize(lengthCount_.size(), 0);
+    for (size_t i = 0; i < canonical.size(); ++i) {
+      size_t length = canonical[i].size();
+      if (lengthCount_[length]++ == 0) {
+        firstCode_[length] = std::stoull(canonical[i], nullptr, 2);
+        firstIndex_[length] = i;
+      }
+      sortedSymbols_ += static_cast< char >(lengths[i].second);
+    }
+  }
+  table_.resize(size_t(1) << lookupBits_);
+  for (size_t i = 0; i < table_.size(); ++i) {
+    int node = 0;
+    size_t length = 0;
+    while (length < lookupBits_ && node != -1 && !trie_[node].isLeaf) {
+      size_t bit = (i >> (lookupBits_ - length - 1)) & 1;
+      node = trie_[node].child[bit];
+      ++length;
+    }
+    bool isLeaf = node != -1 && trie_[node].isLeaf;
+    table_[i] = Entry{ node, static_cast< unsigned char >(length), isLeaf };
+  }
+}
+
+void nikonov::DecodeTable::insertCode(const str& code, char character)
+{
+  int node = 0;
+  for (char bit : code) {
+    size_t index = bit == '1' ? 1 : 0;
+    if (trie_[node].child[index] == -1) {
+      trie_[node].child[index] = static_cast< int >(trie_.size());
+      trie_.push_back(TrieNode{ { -1, -1 }, false, '\0' });
+    }
+    node = trie_[node].child[index];
+  }
+  if (!trie_[node].isLeaf) {
+    trie_[node].isLeaf = true;
+    trie_[node].character = character;
+  }
+}
+
+size_t nikonov::DecodeTable::peek(const PackedBits& packed, size_t pos) const
+{
+  size_t byte = pos / 8;
+  size_t window = 0;
+  for (size_t i = 0; i < 3; ++i) {
+    window <<= 8;
+    if (byte + i < packed.data.size()) {
+      window |= packed.data[byte + i];
+    }
+  }
+  return (window >> (24 - pos % 8 - lookupBits_)) & (table_.size() - 1);
+}
+
+bool nikonov::DecodeTable::walk(const PackedBits& packed, size_t& pos, int node, char& character) const
+{
+  while (node != -1 && !trie_[node].isLeaf && pos < packed.bitCount) {
+    size_t bit = (packed.data[pos / 8] >> (7 - pos % 8)) & 1;
+    node = trie_[node].child[bit];
+    ++pos;
+  }
+  if (node == -1 || !trie_[node].isLeaf) {
+    return false;
+  }
+  character = trie_[node].character;
+  return true;
+}
+
+bool nikonov::DecodeTable::walkCanonical(const PackedBits& packed, size_t& pos, unsigned long long code, size_t length,
+    char& character) const
+{
+  while (length + 1 < lengthCount_.size() && pos < packed.bitCount) {
+    code = (code << 1) | ((packed.data[pos / 8] >> (7 - pos % 8)) & 1);
+    ++pos;
+    ++length;
+    if (code - firstCode_[length] < lengthCount_[length]) {
+      character = sortedSymbols_[firstIndex_[length] + (code - firstCode_[length])];
+      return true;
+    }
+  }
+  return false;
+}
+
+bool nikonov::DecodeTable::isCanonical() const
+{
+  return canonical_;
+}
+
+std::string nikonov::DecodeTable::decode(const PackedBits& packed) const
 {
   str decompressed;
-  str currentCode;
-  for (char bit : compressed) {
-    currentCode += bit;
-    if (reverseCodes.find(currentCode) != reverseCodes.end()) {
-      decompressed += reverseCodes.at(currentCode);
-      currentCode.clear();
+  size_t pos = 0;
+  while (pos < packed.bitCount) {
+    size_t window = peek(packed, pos);
+    const Entry& entry = table_[window];
+    if (entry.node == -1) {
+      break;
+    }
+    char character = '\0';
+    bool decoded = true;
+    if (pos + entry.length > packed.bitCount) {
+      decoded = canonical_ ? walkCanonical(packed, pos, 0, 0, character) : walk(packed, pos, 0, character);
+    } else if (entry.isLeaf) {
+      pos += entry.length;
+      character = trie_[entry.node].character;
+    } else {
+      pos += entry.length;
+      decoded = canonical_ ? walkCanonical(packed, pos, window, entry.length, character)
+          : walk(packed, pos, entry.node, character);
+    }
+    if (!decoded) {
+      break;
     }
+    decompressed += character;
   }
   return decompressed;
 }
@@ -15,14 +15,52 @@ namespace nikonov {
     HuffmanNode(char c, int freq);
   };
 
+  using bytes = std::vector< unsigned char >;
+
+  struct PackedBits {
+    bytes data;
+    size_t bitCount;
+  };
+
+  class DecodeTable {
+  public:
+    explicit DecodeTable(const std::unordered_map< std::string, char >& reverseCodes);
+    std::string decode(const PackedBits& packed) const;
+    bool isCanonical() const;
+  private:
+    struct TrieNode {
+      int child[2];
+      bool isLeaf;
+      char character;
+    };
+    struct Entry {
+      int node;
+      unsigned char length;
+      bool isLeaf;
+    };
+    std::vector< TrieNode > trie_;
+    std::vector< Entry > table_;
+    size_t lookupBits_;
+    bool canonical_;
+    std::vector< unsigned long long > firstCode_;
+    std::vector< size_t > firstIndex_;
+    std::vector< size_t > lengthCount_;
+    std::string sortedSymbols_;
+    void insertCode(const std::string& code, char character);
+    size_t peek(const PackedBits& packed, size_t pos) const;
+    bool walk(const PackedBits& packed, size_t& pos, int node, char& character) const;
+    bool walkCanonical(const PackedBits& packed, size_t& pos, unsigned long long code, size_t length, char& character) const;
+  };
+
   class HuffmanCore {
   public:
     static std::unordered_map< char, std::string > buildCodes(const std::string& text);
-    static std::string compress(const std::string& text, const std::unordered_map< char, std::string >& codes);
-    static std::string decompress(const std::string& compressed, const std::unordered_map< std::string, char >& reverseCodes);
+    static PackedBits compress(const std::string& text, const std::unordered_map< char, std::string >& codes);
+    static std::string decompress(const PackedBits& compressed, const std::unordered_map< std::string, char >& reverseCodes);
   private:
     static std::unordered_map< char, int > calculateFrequency(const std::string& text);
     static void buildCodeTable(HuffmanNode* node, const std::string& code, std::unordered_map< char, std::string >& codes);
+    static void canonicalize(std::unordered_map< char, std::string >& codes);
   };
 }
 #endif
@@ -0,0 +1,110 @@
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <random>
+#include "DataStorage.hpp"
+#include "HuffmanCore.hpp"
+
+// Decoding benchmark: DecodeTable against the former string-per-bit decompress.
+// Run with `make test-nikonov.andrew/F0 TEST_ARGS="--log_level=message -- <megabytes>"` (1 MB by default).
+namespace {
+  using nikonov::str;
+  using Clock = std::chrono::steady_clock;
+
+  size_t benchmarkMegabytes()
+  {
+    const auto& suite = boost::unit_test::framework::master_test_suite();
+    return suite.argc > 1 ? std::stoul(suite.argv[1]) : 1;
+  }
+
+  str skewedText(size_t size)
+  {
+    std::mt19937 generator(42);
+    std::geometric_distribution< int > distribution(0.25);
+    str text;
+    text.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+      text += static_cast< char >(' ' + std::min(distribution(generator), 94));
+    }
+    return text;
+  }
+
+  str unpack(const nikonov::PackedBits& packed)
+  {
+    str bits;
+    bits.reserve(packed.bitCount);
+    for (size_t i = 0; i < packed.bitCount; ++i) {
+      bits += (packed.data[i / 8] >> (7 - i % 8)) & 1 ? '1' : '0';
+    }
+    return bits;
+  }
+
+  str legacyDecompress(const str& compressed, const std::unordered_map< str, char >& reverseCodes)
+  {
+    str decompressed;
+    str currentCode;
+    for (char bit : compressed) {
+      currentCode += bit;
+      if (reverseCodes.find(currentCode) != reverseCodes.end()) {
+        decompressed += reverseCodes.at(currentCode);
+        currentCode.clear();
+      }
+    }
+    return decompressed;
+  }
+
+  double megabytesPerSecond(size_t bytes, Clock::duration elapsed)
+  {
+    return bytes / 1e6 / std::max(std::chrono::duration< double >(elapsed).count(), 1e-9);
+  }
+
+  void compareDecoders(const str& text, const std::unordered_map< char, str >& codes, bool canonical)
+  {
+    nikonov::PackedBits packed = nikonov::HuffmanCore::compress(text, codes);
+    nikonov::Encoding encoding(codes);
+    const auto& reverseCodes = encoding.getReverseTable();
+    str bits = unpack(packed);
+
+    auto start = Clock::now();
+    str legacy = legacyDecompress(bits, reverseCodes);
+    auto legacyTime = Clock::now() - start;
+    start = Clock::now();
+    nikonov::DecodeTable table(reverseCodes);
+    str decoded = table.decode(packed);
+    auto tableTime = Clock::now() - start;
+
+    BOOST_CHECK_EQUAL(table.isCanonical(), canonical);
+    BOOST_CHECK(legacy == text);
+    BOOST_CHECK(decoded == text);
+    BOOST_TEST_MESSAGE((canonical ? "canonical codes: " : "non-canonical codes: ") << text.size() << " bytes, "
+        << "string-per-bit " << megabytesPerSecond(text.size(), legacyTime) << " MB/s, "
+        << "DecodeTable " << megabytesPerSecond(text.size(), tableTime) << " MB/s");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(decode_canonical_codes)
+{
+  str text = skewedText(benchmarkMegabytes() << 20);
+  compareDecoders(text, nikonov::HuffmanCore::buildCodes(text), true);
+}
+
+BOOST_AUTO_TEST_CASE(decode_non_canonical_codes)
+{
+  str text = skewedText(benchmarkMegabytes() << 20);
+  std::unordered_map< char, str > codes = nikonov::HuffmanCore::buildCodes(text);
+  for (auto& pair : codes) {
+    for (char& bit : pair.second) {
+      bit = bit == '0' ? '1' : '0';
+    }
+  }
+  compareDecoders(text, codes, false);
+}
+
+BOOST_AUTO_TEST_CASE(decode_stops_on_truncated_code)
+{
+  std::unordered_map< char, str > codes = { { 'a', "0" }, { 'b', "10" }, { 'c', "11" } };
+  nikonov::PackedBits packed = nikonov::HuffmanCore::compress("abcab", codes);
+  --packed.bitCount;
+  nikonov::DecodeTable table(nikonov::Encoding(codes).getReverseTable());
+  BOOST_CHECK(table.isCanonical());
+  BOOST_CHECK_EQUAL(table.decode(packed), "abca");
+}
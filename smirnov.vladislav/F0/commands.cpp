@@ -453,7 +453,7 @@ namespace smirnov
     }
   }
 
-  std::map< std::string, CommandFunction > createCommandMap(DictionaryManager& dm, std::ostream& os)
+  std::map< std::string, CommandFunction > createCommandMap()
   {
     std::map< std::string, CommandFunction > commandMap;
 
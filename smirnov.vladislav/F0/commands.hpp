@@ -30,7 +30,7 @@ namespace smirnov
 
   using CommandFunction = std::function< void(const std::vector< std::string >&, DictionaryManager&, std::ostream&) >;
 
-  std::map< std::string, CommandFunction > createCommandMap(DictionaryManager& dm, std::ostream& os);
+  std::map< std::string, CommandFunction > createCommandMap();
 }
 
 #endif
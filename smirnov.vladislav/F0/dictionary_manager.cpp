@@ -4,33 +4,61 @@
 #include <algorithm>
 #include <iterator>
 #include <stdexcept>
+#include <thread>
+
+using FreqEntries = std::vector< std::pair< std::string, int > >;
 
 struct MergePredicate
 {
-  std::map< std::string, int >& mergedDict_;
-  MergePredicate(std::map< std::string, int >& dict) : mergedDict_(dict) {}
+  FrequencyDict& mergedDict_;
+  MergePredicate(FrequencyDict& dict) : mergedDict_(dict) {}
   void operator()(const std::pair< const std::string, int >& p) const
   {
-    mergedDict_[p.first] += p.second;
+    mergedDict_.add(p.first, p.second);
   }
 };
 
 struct IntersectPredicate
 {
-  const std::map< std::string, int >* otherDict_;
-  std::map< std::string, int >& intersectionDict_;
-  IntersectPredicate(const std::map< std::string, int >* other, std::map< std::string, int >& intersection) :
-    otherDict_(other), intersectionDict_(intersection) {}
+  const FrequencyDict* otherDict_;
+  FreqEntries& intersection_;
+  IntersectPredicate(const FrequencyDict* other, FreqEntries& intersection) :
+    otherDict_(other), intersection_(intersection) {}
   void operator()(const std::pair< const std::string, int >& p) const
   {
     auto oit = otherDict_->find(p.first);
     if (oit != otherDict_->end())
     {
-      intersectionDict_[p.first] = std::min(p.second, oit->second);
+      intersection_.emplace_back(p.first, std::min(p.second, oit->second));
     }
   }
 };
 
+// Builds the sub-dictionary of base holding exactly the sorted entries in kept. When most of base
+// survives, the result is derived from base so that only the removed and changed keys cost memory.
+FrequencyDict deriveSubset(const FrequencyDict& base, const FreqEntries& kept)
+{
+  if (kept.size() * 2 <= base.size())
+  {
+    return FrequencyDict(kept);
+  }
+  FrequencyDict derived = base;
+  auto keptIt = kept.begin();
+  for (const auto& entry: base)
+  {
+    if (keptIt != kept.end() && keptIt->first == entry.first)
+    {
+      derived.assign(keptIt->first, keptIt->second);
+      ++keptIt;
+    }
+    else
+    {
+      derived.erase(entry.first);
+    }
+  }
+  return derived;
+}
+
 char toLowerChar(unsigned char c)
 {
     return static_cast< char >(std::tolower(c));
@@ -51,23 +79,84 @@ struct SaveToFilePredicate
   }
 };
 
-struct FilterByPatternPredicate
+using DictEntry = std::pair< const std::string, int >;
+
+struct FilterScanTask
 {
-  const std::regex& pattern_;
-  FilterByPatternPredicate(const std::regex& p) : pattern_(p) {}
-  bool operator()(const std::pair< const std::string, int >& p) const
+  const CompiledPattern& pattern_;
+  const std::vector< const DictEntry* >& candidates_;
+  std::vector< char >& matched_;
+  std::exception_ptr& error_;
+  size_t begin_;
+  size_t end_;
+
+  void operator()() const
   {
-    return std::regex_match(p.first, pattern_);
+    try
+    {
+      for (size_t i = begin_; i < end_; ++i)
+      {
+        matched_[i] = std::regex_match(candidates_[i]->first, pattern_.regex_);
+      }
+    }
+    catch (...)
+    {
+      error_ = std::current_exception();
+    }
   }
 };
 
-const std::map< std::string, int >* DictionaryManager::getDictByName(const std::string& name) const
+const size_t MIN_CANDIDATES_PER_THREAD = 2048;
+
+std::vector< char > matchCandidates(const CompiledPattern& pattern, const std::vector< const DictEntry* >& candidates)
+{
+  std::vector< char > matched(candidates.size(), 0);
+  size_t threads = std::max< size_t >(1, std::thread::hardware_concurrency());
+  threads = std::min(threads, std::max< size_t >(1, candidates.size() / MIN_CANDIDATES_PER_THREAD));
+
+  std::vector< std::exception_ptr > errors(threads);
+  std::vector< std::thread > workers;
+  workers.reserve(threads - 1);
+  size_t step = (candidates.size() + threads - 1) / threads;
+  try
+  {
+    for (size_t t = 1; t < threads; ++t)
+    {
+      size_t begin = std::min(candidates.size(), t * step);
+      size_t end = std::min(candidates.size(), begin + step);
+      workers.emplace_back(FilterScanTask{ pattern, candidates, matched, errors[t], begin, end });
+    }
+  }
+  catch (...)
+  {
+    for (std::thread& worker: workers)
+    {
+      worker.join();
+    }
+    throw;
+  }
+  FilterScanTask{ pattern, candidates, matched, errors[0], 0, std::min(candidates.size(), step) }();
+  for (std::thread& worker: workers)
+  {
+    worker.join();
+  }
+  for (const std::exception_ptr& error: errors)
+  {
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
+  return matched;
+}
+
+const FrequencyDict* DictionaryManager::getDictByName(const std::string& name) const
 {
   auto it = dicts_.find(name);
   return it == dicts_.end() ? nullptr : &(it->second);
 }
 
-std::map< std::string, int >* DictionaryManager::getCurrentDictMutable()
+FrequencyDict* DictionaryManager::getCurrentDictMutable()
 {
   if (stack_.empty())
   {
@@ -77,7 +166,7 @@ std::map< std::string, int >* DictionaryManager::getCurrentDictMutable()
   return it == dicts_.end() ? nullptr : &(it->second);
 }
 
-const std::map<std::string, int>* DictionaryManager::getCurrentDict() const
+const FrequencyDict* DictionaryManager::getCurrentDict() const
 {
   if (stack_.empty())
   {
@@ -89,7 +178,7 @@ const std::map<std::string, int>* DictionaryManager::getCurrentDict() const
 
 bool DictionaryManager::createDict(const std::string& name)
 {
-  auto inserted = dicts_.emplace(name, std::map< std::string, int >{});
+  auto inserted = dicts_.emplace(name, FrequencyDict{});
   return inserted.second;
 }
 
@@ -130,7 +219,7 @@ bool DictionaryManager::addWord(const std::string& word, int freq_val)
   {
     return false;
   }
-  (*dict)[word] += freq_val;
+  dict->add(word, freq_val);
   return true;
 }
 
@@ -142,14 +231,7 @@ bool DictionaryManager::removeWord(const std::string& word)
     return false;
   }
 
-  auto it = dict->find(word);
-  if (it == dict->end())
-  {
-    return false;
-  }
-
-  dict->erase(it);
-  return true;
+  return dict->erase(word);
 }
 
 bool DictionaryManager::getFreq(const std::string& word, int& freq) const
@@ -189,8 +271,10 @@ bool DictionaryManager::mergeDictionaries(const std::string& otherName, const st
     return false;
   }
 
-  std::map< std::string, int > mergedDict = *currentDict;
-  std::for_each(otherDict->begin(), otherDict->end(),
+  const FrequencyDict& larger = currentDict->size() < otherDict->size() ? *otherDict : *currentDict;
+  const FrequencyDict& smaller = currentDict->size() < otherDict->size() ? *currentDict : *otherDict;
+  FrequencyDict mergedDict = larger;
+  std::for_each(smaller.begin(), smaller.end(),
     MergePredicate(mergedDict));
   dicts_[newDictName] = std::move(mergedDict);
   return true;
@@ -215,15 +299,15 @@ bool DictionaryManager::intersectDictionaries(const std::string& otherName, cons
     return false;
   }
 
-  std::map< std::string, int > intersectionDict;
+  FreqEntries intersection;
   std::for_each(currentDict->begin(), currentDict->end(),
-    IntersectPredicate(otherDict, intersectionDict));
-  dicts_[newDictName] = std::move(intersectionDict);
+    IntersectPredicate(otherDict, intersection));
+  dicts_[newDictName] = deriveSubset(*currentDict, intersection);
   return true;
 }
 bool DictionaryManager::loadFromFile(const std::string & filename)
 {
-  std::map< std::string, int >* currentDict = getCurrentDictMutable();
+  FrequencyDict* currentDict = getCurrentDictMutable();
   if (!currentDict)
   {
     return false;
@@ -237,6 +321,7 @@ bool DictionaryManager::loadFromFile(const std::string & filename)
 
   currentDict->clear();
 
+  std::map< std::string, int > counts;
   std::string word;
   while (file >> word)
   {
@@ -244,10 +329,11 @@ bool DictionaryManager::loadFromFile(const std::string & filename)
     word.erase(std::remove_if(word.begin(), word.end(), isNotAlpha), word.end());
     if (!word.empty())
     {
-      (*currentDict)[word]++;
+      counts[word]++;
     }
   }
   file.close();
+  *currentDict = FrequencyDict(FreqEntries(counts.begin(), counts.end()));
 
   if (!file.eof() && file.fail())
   {
@@ -294,21 +380,43 @@ bool DictionaryManager::filterByPattern(const std::string& regex_str, const std:
     return false;
   }
 
-  std::regex pattern;
-  try
+  std::shared_ptr< const CompiledPattern > pattern = patternCache_.get(regex_str);
+
+  FreqEntries filtered;
+  if (pattern->isLiteral_)
   {
-    pattern = std::regex(regex_str);
+    auto it = currentDict->find(pattern->literal_);
+    if (it != currentDict->end())
+    {
+      filtered.emplace_back(*it);
+    }
+    dicts_[resultDictName] = FrequencyDict(filtered);
+    return true;
   }
-  catch (const std::regex_error&)
+
+  std::vector< const DictEntry* > candidates;
+  const std::string& prefix = pattern->prefix_;
+  for (auto it = currentDict->lower_bound(prefix); it != currentDict->end(); ++it)
   {
-    throw;
+    if (it->first.compare(0, prefix.size(), prefix) != 0)
+    {
+      break;
+    }
+    if (pattern->mayMatch(it->first))
+    {
+      candidates.push_back(&*it);
+    }
   }
 
-  std::map< std::string, int > filteredDict;
-  std::copy_if(currentDict->begin(), currentDict->end(),
-    std::inserter(filteredDict, filteredDict.begin()),
-    FilterByPatternPredicate(pattern));
-  dicts_[resultDictName] = std::move(filteredDict);
+  std::vector< char > matched = matchCandidates(*pattern, candidates);
+  for (size_t i = 0; i < candidates.size(); ++i)
+  {
+    if (matched[i])
+    {
+      filtered.emplace_back(*candidates[i]);
+    }
+  }
+  dicts_[resultDictName] = deriveSubset(*currentDict, filtered);
   return true;
 }
 
@@ -5,6 +5,8 @@
 #include <map>
 #include <vector>
 #include <regex>
+#include "frequency_dict.hpp"
+#include "pattern_cache.hpp"
 
 class DictionaryManager
 {
@@ -35,13 +37,14 @@ public:
   bool loadFromFile(const std::string& filename);
   bool saveToFile(const std::string& filename) const;
 
-  std::map< std::string, int >* getCurrentDictMutable();
-  const std::map< std::string, int >* getCurrentDict() const;
-  const std::map< std::string, int >* getDictByName(const std::string& name) const;
+  FrequencyDict* getCurrentDictMutable();
+  const FrequencyDict* getCurrentDict() const;
+  const FrequencyDict* getDictByName(const std::string& name) const;
 
 private:
-  std::map< std::string, std::map< std::string, int > > dicts_;
+  std::map< std::string, FrequencyDict > dicts_;
   std::vector< std::string > stack_;
+  PatternCache patternCache_;
 };
 
 #endif
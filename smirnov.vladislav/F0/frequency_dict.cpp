@@ -0,0 +1,282 @@
+#include "frequency_dict.hpp"
+#include <functional>
+
+struct FrequencyDict::Node
+{
+  value_type entry;
+  size_t priority;
+  NodePtr left;
+  NodePtr right;
+
+  Node(const value_type& e, size_t p, const NodePtr& l, const NodePtr& r) :
+    entry(e), priority(p), left(l), right(r)
+  {}
+};
+
+namespace
+{
+  size_t priorityOf(const std::string& key)
+  {
+    return std::hash< std::string >()(key);
+  }
+}
+
+struct FrequencyTreap
+{
+  using Node = FrequencyDict::Node;
+  using NodePtr = FrequencyDict::NodePtr;
+
+  static NodePtr withChildren(const NodePtr& node, const NodePtr& left, const NodePtr& right)
+  {
+    return std::make_shared< const Node >(node->entry, node->priority, left, right);
+  }
+
+  static void split(const NodePtr& node, const std::string& key, NodePtr& left, NodePtr& right)
+  {
+    if (!node)
+    {
+      left = nullptr;
+      right = nullptr;
+    }
+    else if (node->entry.first < key)
+    {
+      NodePtr middle;
+      split(node->right, key, middle, right);
+      left = withChildren(node, node->left, middle);
+    }
+    else
+    {
+      NodePtr middle;
+      split(node->left, key, left, middle);
+      right = withChildren(node, middle, node->right);
+    }
+  }
+
+  static NodePtr join(const NodePtr& left, const NodePtr& right)
+  {
+    if (!left)
+    {
+      return right;
+    }
+    if (!right)
+    {
+      return left;
+    }
+    if (left->priority >= right->priority)
+    {
+      return withChildren(left, left->left, join(left->right, right));
+    }
+    return withChildren(right, join(left, right->left), right->right);
+  }
+
+  static NodePtr insert(const NodePtr& node, const NodePtr& leaf)
+  {
+    if (!node || leaf->priority > node->priority)
+    {
+      NodePtr left;
+      NodePtr right;
+      split(node, leaf->entry.first, left, right);
+      return std::make_shared< const Node >(leaf->entry, leaf->priority, left, right);
+    }
+    if (leaf->entry.first < node->entry.first)
+    {
+      return withChildren(node, insert(node->left, leaf), node->right);
+    }
+    return withChildren(node, node->left, insert(node->right, leaf));
+  }
+
+  static NodePtr update(const NodePtr& node, const std::string& key, int value)
+  {
+    if (key < node->entry.first)
+    {
+      return withChildren(node, update(node->left, key, value), node->right);
+    }
+    if (node->entry.first < key)
+    {
+      return withChildren(node, node->left, update(node->right, key, value));
+    }
+    return std::make_shared< const Node >(FrequencyDict::value_type(key, value), node->priority, node->left, node->right);
+  }
+
+  static NodePtr erase(const NodePtr& node, const std::string& key)
+  {
+    if (key < node->entry.first)
+    {
+      return withChildren(node, erase(node->left, key), node->right);
+    }
+    if (node->entry.first < key)
+    {
+      return withChildren(node, node->left, erase(node->right, key));
+    }
+    return join(node->left, node->right);
+  }
+};
+
+FrequencyDict::FrequencyDict() :
+  root_(), size_(0)
+{}
+
+FrequencyDict::FrequencyDict(const std::vector< std::pair< std::string, int > >& sorted) :
+  root_(), size_(sorted.size())
+{
+  std::vector< std::shared_ptr< Node > > spine;
+  for (const auto& item: sorted)
+  {
+    auto node = std::make_shared< Node >(item, priorityOf(item.first), nullptr, nullptr);
+    std::shared_ptr< Node > last;
+    while (!spine.empty() && spine.back()->priority < node->priority)
+    {
+      last = spine.back();
+      spine.pop_back();
+    }
+    node->left = last;
+    if (!spine.empty())
+    {
+      spine.back()->right = node;
+    }
+    spine.push_back(node);
+  }
+  if (!spine.empty())
+  {
+    root_ = spine.front();
+  }
+}
+
+size_t FrequencyDict::size() const
+{
+  return size_;
+}
+
+bool FrequencyDict::empty() const
+{
+  return size_ == 0;
+}
+
+FrequencyDict::const_iterator FrequencyDict::begin() const
+{
+  const_iterator it;
+  for (const Node* node = root_.get(); node; node = node->left.get())
+  {
+    it.path_.push_back(node);
+  }
+  return it;
+}
+
+FrequencyDict::const_iterator FrequencyDict::end() const
+{
+  return const_iterator();
+}
+
+FrequencyDict::const_iterator FrequencyDict::lower_bound(const std::string& key) const
+{
+  const_iterator it;
+  const Node* node = root_.get();
+  while (node)
+  {
+    if (node->entry.first < key)
+    {
+      node = node->right.get();
+    }
+    else
+    {
+      it.path_.push_back(node);
+      node = node->left.get();
+    }
+  }
+  return it;
+}
+
+FrequencyDict::const_iterator FrequencyDict::find(const std::string& key) const
+{
+  const_iterator it = lower_bound(key);
+  if (it == end() || it->first != key)
+  {
+    return end();
+  }
+  return it;
+}
+
+void FrequencyDict::add(const std::string& key, int delta)
+{
+  const_iterator it = find(key);
+  if (it != end())
+  {
+    root_ = FrequencyTreap::update(root_, key, it->second + delta);
+    return;
+  }
+  auto leaf = std::make_shared< const Node >(value_type(key, delta), priorityOf(key), nullptr, nullptr);
+  root_ = FrequencyTreap::insert(root_, leaf);
+  ++size_;
+}
+
+void FrequencyDict::assign(const std::string& key, int value)
+{
+  const_iterator it = find(key);
+  if (it == end())
+  {
+    add(key, value);
+  }
+  else if (it->second != value)
+  {
+    root_ = FrequencyTreap::update(root_, key, value);
+  }
+}
+
+bool FrequencyDict::erase(const std::string& key)
+{
+  if (find(key) == end())
+  {
+    return false;
+  }
+  root_ = FrequencyTreap::erase(root_, key);
+  --size_;
+  return true;
+}
+
+void FrequencyDict::clear()
+{
+  root_ = nullptr;
+  size_ = 0;
+}
+
+FrequencyDict::const_iterator::reference FrequencyDict::const_iterator::operator*() const
+{
+  return path_.back()->entry;
+}
+
+FrequencyDict::const_iterator::pointer FrequencyDict::const_iterator::operator->() const
+{
+  return &path_.back()->entry;
+}
+
+FrequencyDict::const_iterator& FrequencyDict::const_iterator::operator++()
+{
+  const Node* node = path_.back()->right.get();
+  path_.pop_back();
+  for (; node; node = node->left.get())
+  {
+    path_.push_back(node);
+  }
+  return *this;
+}
+
+FrequencyDict::const_iterator FrequencyDict::const_iterator::operator++(int)
+{
+  const_iterator copy = *this;
+  ++(*this);
+  return copy;
+}
+
+bool FrequencyDict::const_iterator::operator==(const const_iterator& other) const
+{
+  if (path_.empty() || other.path_.empty())
+  {
+    return path_.empty() && other.path_.empty();
+  }
+  return path_.back() == other.path_.back();
+}
+
+bool FrequencyDict::const_iterator::operator!=(const const_iterator& other) const
+{
+  return !(*this == other);
+}
@@ -0,0 +1,64 @@
+#ifndef FREQUENCY_DICT_HPP
+#define FREQUENCY_DICT_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Persistent word -> frequency map: copies are O(1) and share every node,
+// modifications copy only the path to the changed key.
+class FrequencyDict
+{
+  friend struct FrequencyTreap;
+  struct Node;
+  using NodePtr = std::shared_ptr< const Node >;
+
+public:
+  using value_type = std::pair< const std::string, int >;
+
+  class const_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = FrequencyDict::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    const_iterator() = default;
+    reference operator*() const;
+    pointer operator->() const;
+    const_iterator& operator++();
+    const_iterator operator++(int);
+    bool operator==(const const_iterator& other) const;
+    bool operator!=(const const_iterator& other) const;
+
+  private:
+    friend class FrequencyDict;
+    std::vector< const Node* > path_;
+  };
+
+  FrequencyDict();
+  explicit FrequencyDict(const std::vector< std::pair< std::string, int > >& sorted);
+
+  size_t size() const;
+  bool empty() const;
+  const_iterator begin() const;
+  const_iterator end() const;
+  const_iterator find(const std::string& key) const;
+  const_iterator lower_bound(const std::string& key) const;
+
+  void add(const std::string& key, int delta);
+  void assign(const std::string& key, int value);
+  bool erase(const std::string& key);
+  void clear();
+
+private:
+  NodePtr root_;
+  size_t size_;
+};
+
+#endif
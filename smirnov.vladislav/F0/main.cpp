@@ -1,6 +1,6 @@
 #include <iostream>
 #include <string>
-#include <limits>  
+#include <limits>
 #include "commands.hpp"
 
 std::vector< std::string > splitString(const std::string& str)
@@ -38,10 +38,10 @@ std::vector< std::string > splitString(const std::string& str)
   return tokens;
 }
 
-int main(int argc, char* argv[])
+int main()
 {
   DictionaryManager dm;
-  auto commandMap = createCommandMap();
+  auto commandMap = smirnov::createCommandMap();
   std::string line;
   while (std::getline(std::cin, line))
   {
@@ -0,0 +1,249 @@
+#include "pattern_cache.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace
+{
+  struct LiteralScanner
+  {
+    const std::string& source_;
+    size_t pos_;
+    std::string run_;
+    std::string prefix_;
+    std::string longest_;
+    bool inPrefix_;
+    bool pureLiteral_;
+    bool usable_;
+
+    explicit LiteralScanner(const std::string& source) :
+      source_(source), pos_(0), run_(), prefix_(), longest_(), inPrefix_(true), pureLiteral_(true), usable_(true)
+    {}
+
+    void endRun()
+    {
+      if (inPrefix_)
+      {
+        prefix_ = run_;
+        inPrefix_ = false;
+      }
+      if (run_.size() > longest_.size())
+      {
+        longest_ = run_;
+      }
+      run_.clear();
+    }
+
+    void breakLiteral()
+    {
+      pureLiteral_ = false;
+      endRun();
+    }
+
+    void skipClass()
+    {
+      ++pos_;
+      while (pos_ < source_.size() && source_[pos_] != ']')
+      {
+        pos_ += source_[pos_] == '\\' ? 2 : 1;
+      }
+      ++pos_;
+    }
+
+    void skipGroup()
+    {
+      size_t depth = 0;
+      while (pos_ < source_.size())
+      {
+        char c = source_[pos_];
+        if (c == '\\')
+        {
+          pos_ += 2;
+          continue;
+        }
+        if (c == '[')
+        {
+          skipClass();
+          continue;
+        }
+        ++pos_;
+        if (c == '(')
+        {
+          ++depth;
+        }
+        else if (c == ')' && --depth == 0)
+        {
+          return;
+        }
+      }
+    }
+
+    // \xHH, \uHHHH, \cX and multi-digit back-references are longer than two characters; their tail
+    // must not end up in the required literal.
+    size_t escapeLength(char kind) const
+    {
+      size_t length = 2;
+      if (kind == 'x' || kind == 'u' || kind == 'c')
+      {
+        length += kind == 'x' ? 2 : kind == 'u' ? 4 : 1;
+      }
+      else if (std::isdigit(static_cast< unsigned char >(kind)))
+      {
+        while (pos_ + length < source_.size() && std::isdigit(static_cast< unsigned char >(source_[pos_ + length])))
+        {
+          ++length;
+        }
+      }
+      return std::min(length, source_.size() - pos_);
+    }
+
+    bool readQuantifier(bool& optional)
+    {
+      if (pos_ >= source_.size())
+      {
+        return false;
+      }
+      char c = source_[pos_];
+      if (c == '*' || c == '?' || c == '+')
+      {
+        optional = c != '+';
+        ++pos_;
+      }
+      else if (c == '{')
+      {
+        char* end = nullptr;
+        unsigned long min = std::strtoul(source_.c_str() + pos_ + 1, &end, 10);
+        size_t close = source_.find('}', pos_);
+        if (end == source_.c_str() + pos_ + 1 || close == std::string::npos)
+        {
+          usable_ = false;
+          return false;
+        }
+        optional = min == 0;
+        pos_ = close + 1;
+      }
+      else
+      {
+        return false;
+      }
+      if (pos_ < source_.size() && source_[pos_] == '?')
+      {
+        ++pos_;
+      }
+      return true;
+    }
+
+    void scan()
+    {
+      if (!source_.empty() && source_[0] == '^')
+      {
+        pureLiteral_ = false;
+        ++pos_;
+      }
+      while (usable_ && pos_ < source_.size())
+      {
+        char c = source_[pos_];
+        bool literal = false;
+        char value = c;
+        if (c == '|')
+        {
+          usable_ = false;
+          return;
+        }
+        else if (c == '\\')
+        {
+          if (pos_ + 1 >= source_.size())
+          {
+            usable_ = false;
+            return;
+          }
+          value = source_[pos_ + 1];
+          literal = !std::isalnum(static_cast< unsigned char >(value));
+          pos_ += escapeLength(value);
+        }
+        else if (c == '[')
+        {
+          skipClass();
+        }
+        else if (c == '(')
+        {
+          skipGroup();
+        }
+        else if (c == '.' || c == '^' || c == '$')
+        {
+          ++pos_;
+        }
+        else
+        {
+          literal = true;
+          ++pos_;
+        }
+
+        bool optional = false;
+        bool quantified = readQuantifier(optional);
+        if (!literal)
+        {
+          breakLiteral();
+          continue;
+        }
+        if (!quantified)
+        {
+          run_ += value;
+          continue;
+        }
+        if (!optional)
+        {
+          run_ += value;
+        }
+        breakLiteral();
+      }
+      endRun();
+    }
+  };
+}
+
+CompiledPattern::CompiledPattern(const std::string& source) :
+  regex_(source), prefix_(), literal_(), isLiteral_(false)
+{
+  LiteralScanner scanner(source);
+  scanner.scan();
+  if (scanner.usable_)
+  {
+    prefix_ = scanner.prefix_;
+    literal_ = scanner.longest_;
+    isLiteral_ = scanner.pureLiteral_;
+  }
+}
+
+bool CompiledPattern::mayMatch(const std::string& word) const
+{
+  if (word.compare(0, prefix_.size(), prefix_) != 0)
+  {
+    return false;
+  }
+  return literal_.empty() || word.find(literal_) != std::string::npos;
+}
+
+PatternCache::PatternCache(size_t capacity) :
+  capacity_(capacity), entries_(), index_()
+{}
+
+std::shared_ptr< const CompiledPattern > PatternCache::get(const std::string& source)
+{
+  auto found = index_.find(source);
+  if (found != index_.end())
+  {
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return found->second->second;
+  }
+
+  auto compiled = std::make_shared< const CompiledPattern >(source);
+  entries_.emplace_front(source, compiled);
+  index_[source] = entries_.begin();
+  if (entries_.size() > capacity_)
+  {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  return compiled;
+}
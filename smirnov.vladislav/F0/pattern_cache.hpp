@@ -0,0 +1,36 @@
+#ifndef PATTERN_CACHE_HPP
+#define PATTERN_CACHE_HPP
+
+#include <list>
+#include <memory>
+#include <regex>
+#include <string>
+#include <unordered_map>
+
+struct CompiledPattern
+{
+  std::regex regex_;
+  std::string prefix_;
+  std::string literal_;
+  bool isLiteral_;
+
+  explicit CompiledPattern(const std::string& source);
+  bool mayMatch(const std::string& word) const;
+};
+
+class PatternCache
+{
+public:
+  explicit PatternCache(size_t capacity = 32);
+
+  std::shared_ptr< const CompiledPattern > get(const std::string& source);
+
+private:
+  using Entry = std::pair< std::string, std::shared_ptr< const CompiledPattern > >;
+
+  size_t capacity_;
+  std::list< Entry > entries_;
+  std::unordered_map< std::string, std::list< Entry >::iterator > index_;
+};
+
+#endif
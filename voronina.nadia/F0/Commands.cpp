@@ -10,6 +10,7 @@
 #include "Commands.h"
 #include "Delimiter.h"
 #include "FileUtilities.h"
+#include "Histogram.h"
 #include "IOFmtguard.h"
 #include "ShannonFano.h"
 
@@ -343,16 +344,16 @@ namespace voronina
       throw std::invalid_argument("Имя файла для записи не может быть пустым");
     }
 
-    std::string text = readFileContents(fileToRead);
+    MappedFile source(fileToRead);
     ShannonFanoTable fanoTable;
-    fanoTable.generateShannonFanoCodes(text, fileToRead);
+    fanoTable.generateShannonFanoCodes(source.begin(), source.end(), fileToRead);
     vectorOfTables.emplace_back(std::move(fanoTable));
     out << "Кодировка успешно построена. Номер кодировки в таблице - ";
     out << vectorOfTables.size() << '\n';
 
-    std::string encodedText = "";
-    int amountOfSignificantBits = vectorOfTables.back().encode(text, encodedText);
-    writeInFile(fileToWrite, encodedText);
+    std::vector< unsigned char > encodedBytes;
+    int amountOfSignificantBits = vectorOfTables.back().encode(source.begin(), source.end(), encodedBytes);
+    writeInFile(fileToWrite, encodedBytes);
     out << "Файл успешно закодирован\n";
     out << "Результат кодирования записан в файл: " << fileToWrite << '\n';
     out << "Количество значащих бит в последнем байте: " << amountOfSignificantBits << '\n';
@@ -418,8 +419,8 @@ namespace voronina
 
     std::size_t encodingIndex = encodingNumber - 1;
 
-    std::string encodedText = readFileContents(fileToRead);
-    std::string decodedText = vectorOfTables[encodingIndex].decode(encodedText, bits % 8);
+    MappedFile encoded(fileToRead);
+    std::string decodedText = vectorOfTables[encodingIndex].decode(encoded.begin(), encoded.end(), bits % 8);
     writeInFile(fileToWrite, decodedText);
     out << "Файл " << fileToRead << " успешно декодирован\n";
     out << "Результат декодирования записан в файл: " << fileToWrite << '\n';
@@ -503,13 +504,16 @@ namespace voronina
       throw std::invalid_argument("Имя файла не может быть пустым");
     }
 
-    std::string text = readFileContents(filename);
-    ShannonFanoTable fanoTable;
-    fanoTable.generateShannonFanoCodes(text);
+    MappedFile source(filename);
+    if (source.size() == 0)
+    {
+      throw std::invalid_argument("Невозможно вычислить энтропию пустого файла");
+    }
+    Histogram histogram = countSymbols(source.begin(), source.end());
 
     out << std::fixed << std::setprecision(2);
     out << "Энтропия текста в файле " << filename << " составляет: ";
-    out << fanoTable.calculateEntropy() << " бит/символ\n";
+    out << calculateEntropy(histogram) << " бит/символ\n";
   }
 
   void origin(const FanoTablesVec& vectorOfTables, std::istream& in, std::ostream& out)
@@ -573,8 +577,8 @@ namespace voronina
     std::transform(begin, end, std::back_inserter(chosenTables), tableChooser);
 
     CodeInfoFunctor functor;
-    auto inserter = std::back_inserter(codes);
-    std::transform(chosenTables.begin(), chosenTables.end(), inserter, functor);
+    auto codesInserter = std::back_inserter(codes);
+    std::transform(chosenTables.begin(), chosenTables.end(), codesInserter, functor);
     out << CodeInfoHeader{};
     std::copy(codes.begin(), codes.end(), std::ostream_iterator< CodeInfo >(out, "\n"));
   }
@@ -695,10 +699,10 @@ namespace voronina
       throw std::invalid_argument("Неверный номер кодировки");
     }
     std::size_t encodingIndex = encodingNumber - 1;
-    std::string text = readFileContents(fileToRead);
-    std::string encodedText = "";
-    int amountOfSignificantBits = vectorOfTables[encodingIndex].encode(text, encodedText);
-    writeInFile(fileToWrite, encodedText);
+    MappedFile source(fileToRead);
+    std::vector< unsigned char > encodedBytes;
+    int amountOfSignificantBits = vectorOfTables[encodingIndex].encode(source.begin(), source.end(), encodedBytes);
+    writeInFile(fileToWrite, encodedBytes);
     out << "Файл успешно закодирован\n";
     out << "Результат кодирования записан в файл: " << fileToWrite << '\n';
     out << "Количество значащих бит в последнем байте: " << amountOfSignificantBits << '\n';
@@ -1,9 +1,80 @@
 #include "FileUtilities.h"
 
 #include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace voronina
 {
+  MappedFile::MappedFile(const std::string& filename):
+    data_(nullptr),
+    size_(0)
+  {
+#ifdef _WIN32
+    std::string contents = readFileContents(filename);
+    buffer_.assign(contents.begin(), contents.end());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+      static const char* prefix = "Ошибка при открытии файла: ";
+      static const char* postfix = ". Проверьте существование такого файла";
+      throw std::invalid_argument(prefix + filename + postfix);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) == -1)
+    {
+      ::close(fd);
+      throw std::runtime_error("Ошибка при чтении файла: " + filename);
+    }
+    size_ = static_cast< std::size_t >(info.st_size);
+    if (size_ != 0)
+    {
+      void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped == MAP_FAILED)
+      {
+        ::close(fd);
+        throw std::runtime_error("Ошибка при чтении файла: " + filename);
+      }
+      data_ = static_cast< const char* >(mapped);
+    }
+    ::close(fd);
+#endif
+  }
+
+  MappedFile::~MappedFile()
+  {
+#ifndef _WIN32
+    if (data_ != nullptr)
+    {
+      ::munmap(const_cast< char* >(data_), size_);
+    }
+#endif
+  }
+
+  const char* MappedFile::begin() const
+  {
+    return data_;
+  }
+
+  const char* MappedFile::end() const
+  {
+    return data_ + size_;
+  }
+
+  std::size_t MappedFile::size() const
+  {
+    return size_;
+  }
+
   std::string readFileContents(std::string const& filename)
   {
     std::ifstream ifs(filename, std::ios::binary | std::ios::ate);
@@ -34,6 +105,16 @@ namespace voronina
     ofs << text;
   }
 
+  void writeInFile(std::string const& filename, std::vector< unsigned char > const& bytes)
+  {
+    std::ofstream ofs(filename, std::ios::binary);
+    if (!ofs.is_open())
+    {
+      throw std::invalid_argument("Ошибка при открытии файла для записи: " + filename);
+    }
+    ofs.write(reinterpret_cast< const char* >(bytes.data()), bytes.size());
+  }
+
   std::streamsize getFileSize(std::string const& fileName)
   {
     std::ifstream file(fileName, std::ios::binary | std::ios::ate);
@@ -2,11 +2,33 @@
 #define FILE_UTILITIES
 
 #include <string>
+#include <vector>
 
 namespace voronina
 {
+  class MappedFile
+  {
+  public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* begin() const;
+    const char* end() const;
+    std::size_t size() const;
+
+  private:
+    const char* data_;
+    std::size_t size_;
+#ifdef _WIN32
+    std::vector< char > buffer_;
+#endif
+  };
+
   std::string readFileContents(std::string const& filename);
   void writeInFile(const std::string& filename, const std::string& text);
+  void writeInFile(const std::string& filename, const std::vector< unsigned char >& bytes);
   std::streamsize getFileSize(const std::string& fileName);
 }
 
@@ -0,0 +1,68 @@
+#include "Histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+
+namespace
+{
+  constexpr std::size_t lanes = 4;
+  constexpr std::size_t flushPeriod = std::size_t(1) << 30;
+}
+
+namespace voronina
+{
+  Histogram countSymbols(const char* begin, const char* end)
+  {
+    std::uint32_t counters[lanes][256] = {};
+    Histogram histogram{};
+    const unsigned char* it = reinterpret_cast< const unsigned char* >(begin);
+    const unsigned char* last = reinterpret_cast< const unsigned char* >(end);
+    while (it != last)
+    {
+      std::size_t chunk = std::min< std::size_t >(last - it, flushPeriod);
+      const unsigned char* chunkEnd = it + chunk;
+      for (; chunkEnd - it >= static_cast< std::ptrdiff_t >(lanes); it += lanes)
+      {
+        ++counters[0][it[0]];
+        ++counters[1][it[1]];
+        ++counters[2][it[2]];
+        ++counters[3][it[3]];
+      }
+      for (; it != chunkEnd; ++it)
+      {
+        ++counters[0][*it];
+      }
+      for (std::size_t lane = 0; lane < lanes; ++lane)
+      {
+        for (std::size_t i = 0; i < 256; ++i)
+        {
+          histogram[i] += counters[lane][i];
+          counters[lane][i] = 0;
+        }
+      }
+    }
+    return histogram;
+  }
+
+  std::size_t totalCount(const Histogram& histogram)
+  {
+    return std::accumulate(histogram.begin(), histogram.end(), std::size_t(0));
+  }
+
+  double calculateEntropy(const Histogram& histogram)
+  {
+    double total = static_cast< double >(totalCount(histogram));
+    double entropy = 0.0;
+    for (std::size_t count : histogram)
+    {
+      if (count != 0)
+      {
+        double frequency = count / total;
+        entropy -= frequency * std::log2(frequency);
+      }
+    }
+    return entropy;
+  }
+}
@@ -0,0 +1,16 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <array>
+#include <cstddef>
+
+namespace voronina
+{
+  using Histogram = std::array< std::size_t, 256 >;
+
+  Histogram countSymbols(const char* begin, const char* end);
+  std::size_t totalCount(const Histogram& histogram);
+  double calculateEntropy(const Histogram& histogram);
+}
+
+#endif
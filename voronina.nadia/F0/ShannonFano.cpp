@@ -3,9 +3,11 @@
 #include <functional>
 #include <iomanip>
 #include <iterator>
+#include <limits>
 #include <numeric>
 #include <vector>
 
+#include "Histogram.h"
 #include "IOFmtguard.h"
 #include "ShannonFano.h"
 
@@ -13,218 +15,48 @@ namespace
 {
   using namespace voronina;
 
-  template < class T >
-  T staticCast(const T& value);
-
-  struct BitExtractor
-  {
-    int j = 7;
-    unsigned char byte;
-
-    BitExtractor(unsigned char b);
-    char operator()();
-  };
-
-  std::string byteToString(unsigned char byte);
-
-  struct ByteGenerator
-  {
-    const std::string& bitMask;
-    int bitMaskLength;
-    int i = 0;
-
-    ByteGenerator(const std::string& bitMask, int bitMaskLength);
-    std::string operator()();
-  };
-
-  struct BitToDecimalAccumulator
-  {
-    int degree = 7;
-    int operator()(int sum, char bit);
-  };
-
-  struct ByteMaskToCharTransformer
-  {
-    char operator()(const std::string& byte) const;
-  };
-
   struct SymbolToSymbolMapEntry
   {
     std::pair< char, Symbol > operator()(const Symbol& symbol) const;
   };
 
-  struct SymbolToCodeMapEntry
+  struct DecodeNode
   {
-    std::pair< std::string, Symbol > operator()(const Symbol& symbol) const;
+    int child[2];
+    int symbol;
   };
 
-  struct SymbolToCodeTransformer
-  {
-    using SymbolMap = std::unordered_map< char, Symbol >;
-    const SymbolMap& symbolMap;
-
-    SymbolToCodeTransformer(const SymbolMap& symbolMap);
-    std::string operator()(const std::string& acc, char symbol) const;
-  };
-
-  struct FrequencySetter
-  {
-    const std::string& text;
-    FrequencySetter(const std::string& text);
-    Symbol operator()(Symbol symbol) const;
-  };
-
-  struct ByteToCharFunctor
-  {
-    ByteGenerator& generator;
-    ByteMaskToCharTransformer& transformer;
-
-    ByteToCharFunctor(ByteGenerator& gen, ByteMaskToCharTransformer& trans);
-
-    char operator()();
-  };
-
-  struct BitMaskExtractor
-  {
-    const std::string& bitMask;
-    int& i;
-    BitMaskExtractor(const std::string& bitMask, int& i);
-    char operator()();
-  };
-
-  int encodeBitMaskToDestination(const std::string& bitMask, std::string& destination);
-
-  double logFrequencyAccumulator(double sum, const Symbol& symb);
-
-  template < class T >
-  T staticCast(const T& value)
-  {
-    return value;
-  }
-
-  BitExtractor::BitExtractor(unsigned char b):
-    byte(b)
-  {}
-
-  char BitExtractor::operator()()
-  {
-    return ((byte >> j--) & 1) + '0';
-  }
-
-  std::string byteToString(unsigned char byte)
-  {
-    std::string result;
-    BitExtractor extractor(byte);
-    std::generate_n(std::back_inserter(result), 8, extractor);
-    return result;
-  }
-
-  ByteGenerator::ByteGenerator(const std::string& bitMask, int bitMaskLength):
-    bitMask(bitMask), bitMaskLength(bitMaskLength)
-  {}
-
-  std::string ByteGenerator::operator()()
-  {
-    std::string byte;
-    int bitsToExtract = std::min(8, bitMaskLength - i);
-    auto extractor = BitMaskExtractor(bitMask, i);
-    std::generate_n(std::back_inserter(byte), bitsToExtract, extractor);
-    return byte;
-  }
-
-  int BitToDecimalAccumulator::operator()(int sum, char bit)
-  {
-    sum += (bit - '0') << degree--;
-    return sum;
-  }
-
-  char ByteMaskToCharTransformer::operator()(const std::string& byte) const
-  {
-    auto accumulator = BitToDecimalAccumulator{};
-    return std::accumulate(byte.begin(), byte.end(), 0, accumulator);
-  }
+  std::vector< DecodeNode > buildDecodeTrie(const std::vector< Symbol >& symbols);
 
   std::pair< char, Symbol > SymbolToSymbolMapEntry::operator()(const Symbol& symbol) const
   {
     return { symbol.symbol, symbol };
   }
 
-  std::pair< std::string, Symbol > SymbolToCodeMapEntry::operator()(const Symbol& symbol) const
-  {
-    return { symbol.code, symbol };
-  }
-
-  SymbolToCodeTransformer::SymbolToCodeTransformer(const SymbolMap& symbolMap):
-    symbolMap(symbolMap)
-  {}
-
-  std::string SymbolToCodeTransformer::operator()(const std::string& acc, char symbol) const
+  std::vector< DecodeNode > buildDecodeTrie(const std::vector< Symbol >& symbols)
   {
-    auto it = symbolMap.find(symbol);
-    if (it != symbolMap.end())
+    std::vector< DecodeNode > trie(1, DecodeNode{ { -1, -1 }, -1 });
+    for (const Symbol& symbol : symbols)
     {
-      return acc + it->second.code;
-    }
-    return acc;
-  }
-
-  FrequencySetter::FrequencySetter(const std::string& text):
-    text(text)
-  {}
-
-  Symbol FrequencySetter::operator()(Symbol symbol) const
-  {
-    auto size = static_cast< double >(text.size());
-    auto count = std::count(text.begin(), text.end(), symbol.symbol);
-    symbol.frequency = count / size;
-    return symbol;
-  }
-
-  ByteToCharFunctor::ByteToCharFunctor(ByteGenerator& gen, ByteMaskToCharTransformer& trans):
-    generator(gen), transformer(trans)
-  {}
-
-  char ByteToCharFunctor::operator()()
-  {
-    return transformer(generator());
-  }
-
-  BitMaskExtractor::BitMaskExtractor(const std::string& bitMask, int& i):
-    bitMask(bitMask), i(i)
-  {}
-
-  char BitMaskExtractor::operator()()
-  {
-    return bitMask[i++];
-  }
-
-  int encodeBitMaskToDestination(const std::string& bitMask, std::string& destination)
-  {
-    int bitMaskLength = bitMask.length();
-    int fullBytes = bitMaskLength / 8;
-    int remainingBits = bitMaskLength % 8;
-
-    ByteGenerator generator(bitMask, bitMaskLength);
-    ByteMaskToCharTransformer transformer;
-    ByteToCharFunctor byteToCharFunctor(generator, transformer);
-    std::generate_n(std::back_inserter(destination), fullBytes, byteToCharFunctor);
-    if (remainingBits)
-    {
-      std::string lastByte = bitMask.substr(fullBytes * 8, remainingBits);
-      lastByte.append(8 - remainingBits, '0');
-      destination += transformer(lastByte);
+      int node = 0;
+      for (char bit : symbol.code)
+      {
+        int index = bit == '1' ? 1 : 0;
+        if (trie[node].child[index] == -1)
+        {
+          trie[node].child[index] = static_cast< int >(trie.size());
+          trie.push_back(DecodeNode{ { -1, -1 }, -1 });
+        }
+        node = trie[node].child[index];
+      }
+      if (node != 0 && trie[node].symbol == -1)
+      {
+        trie[node].symbol = static_cast< unsigned char >(symbol.symbol);
+      }
     }
-    return remainingBits;
+    return trie;
   }
 
-  double logFrequencyAccumulator(double sum, const Symbol& symb)
-  {
-    if (symb.frequency > 0)
-    {
-      return sum + symb.frequency * std::log2(symb.frequency);
-    }
-    return sum;
-  }
 }
 
 namespace voronina
@@ -244,19 +76,20 @@ namespace voronina
     return originFile_;
   }
 
-  void ShannonFanoTable::initializeSymbolFrequencies(const std::string& text)
+  void ShannonFanoTable::initializeSymbolFrequencies(const char* textBegin, const char* textEnd)
   {
-    std::string sortedText = text;
-    std::sort(sortedText.begin(), sortedText.end());
-    auto uniqueEnd = std::unique(sortedText.begin(), sortedText.end());
+    Histogram histogram = countSymbols(textBegin, textEnd);
+    auto size = static_cast< double >(textEnd - textBegin);
     symbols_.clear();
-
-    auto inserter = std::back_inserter(symbols_);
-    std::transform(sortedText.begin(), uniqueEnd, inserter, SymbolCreator{});
-    auto begin = symbols_.begin();
-    auto end = symbols_.end();
-    std::transform(begin, end, begin, FrequencySetter(text));
-    std::sort(begin, end, FrequencyComparator{});
+    for (int c = std::numeric_limits< char >::min(); c <= std::numeric_limits< char >::max(); ++c)
+    {
+      std::size_t count = histogram[static_cast< unsigned char >(c)];
+      if (count != 0)
+      {
+        symbols_.push_back(Symbol{ static_cast< char >(c), "", count / size });
+      }
+    }
+    std::sort(symbols_.begin(), symbols_.end(), FrequencyComparator{});
   }
 
   void ShannonFanoTable::shannonFanoRecursion(const SymbIter& begin, const SymbIter& end)
@@ -291,25 +124,37 @@ namespace voronina
   void ShannonFanoTable::generateShannonFanoCodes(const std::string& text,
                                                   const std::string originFile)
   {
-    if (text.empty())
+    generateShannonFanoCodes(text.data(), text.data() + text.size(), originFile);
+  }
+
+  void ShannonFanoTable::generateShannonFanoCodes(const char* begin, const char* end,
+                                                  const std::string originFile)
+  {
+    if (begin == end)
     {
       static auto errMessage = "Невозможно создать кодировку Шеннона-Фано из пустой строки";
       throw std::invalid_argument(errMessage);
     }
 
     originFile_ = originFile;
-    initializeSymbolFrequencies(text);
+    initializeSymbolFrequencies(begin, end);
     shannonFanoRecursion(symbols_.begin(), symbols_.end() - 1);
 
     auto symbolInserter = std::inserter(symbolMap_, symbolMap_.end());
     auto transformer = SymbolToSymbolMapEntry();
     std::transform(symbols_.begin(), symbols_.end(), symbolInserter, transformer);
-
-    auto codeMapInserter = std::inserter(codeMap_, codeMap_.end());
-    std::transform(symbols_.begin(), symbols_.end(), codeMapInserter, SymbolToCodeMapEntry());
   }
 
   int ShannonFanoTable::encode(const std::string& text, std::string& destination) const
+  {
+    std::vector< unsigned char > bytes;
+    int remainingBits = encode(text.data(), text.data() + text.size(), bytes);
+    destination.append(bytes.begin(), bytes.end());
+    return remainingBits;
+  }
+
+  int ShannonFanoTable::encode(const char* begin, const char* end,
+                               std::vector< unsigned char >& destination) const
   {
     if (symbolMap_.empty())
     {
@@ -317,15 +162,48 @@ namespace voronina
           "Contract violation: symbolMap_ must be initialized before encoding. "
           "Call generateShannonFanoCodes() first.");
     }
-    auto transformer = SymbolToCodeTransformer(symbolMap_);
-    auto begin = text.begin();
-    auto end = text.end();
-    std::string bitMask = std::accumulate(begin, end, std::string{}, transformer);
-    return encodeBitMaskToDestination(bitMask, destination);
+    std::vector< const std::string* > codes(256, nullptr);
+    for (const Symbol& symbol : symbols_)
+    {
+      codes[static_cast< unsigned char >(symbol.symbol)] = &symbol.code;
+    }
+
+    destination.reserve(destination.size() + (end - begin) / 2);
+    unsigned int current = 0;
+    int filled = 0;
+    for (const char* it = begin; it != end; ++it)
+    {
+      const std::string* code = codes[static_cast< unsigned char >(*it)];
+      if (code == nullptr)
+      {
+        continue;
+      }
+      for (char bit : *code)
+      {
+        current = (current << 1) | (bit == '1' ? 1 : 0);
+        if (++filled == 8)
+        {
+          destination.push_back(static_cast< unsigned char >(current));
+          current = 0;
+          filled = 0;
+        }
+      }
+    }
+    if (filled != 0)
+    {
+      destination.push_back(static_cast< unsigned char >(current << (8 - filled)));
+    }
+    return filled;
   }
 
   std::string ShannonFanoTable::decode(const std::string& text,
                                        int significantBitsInLastByte) const
+  {
+    return decode(text.data(), text.data() + text.size(), significantBitsInLastByte);
+  }
+
+  std::string ShannonFanoTable::decode(const char* begin, const char* end,
+                                       int significantBitsInLastByte) const
   {
     if (symbolMap_.empty())
     {
@@ -339,45 +217,32 @@ namespace voronina
                                   "должно быть в диапазоне от 0 до 7");
     }
 
-    std::vector< unsigned char > bytes;
-    bytes.reserve(text.size());
-
-    using namespace std::placeholders;
-    auto toUnsignedChar = std::bind(staticCast< unsigned char >, _1);
-    std::transform(text.begin(), text.end(), std::back_inserter(bytes), toUnsignedChar);
-
-    std::vector< std::string > bitMasks;
-    std::transform(bytes.begin(), bytes.end(), std::back_inserter(bitMasks), byteToString);
-    std::string bitMask = std::accumulate(bitMasks.begin(), bitMasks.end(), std::string{});
-
-    std::size_t bitMaskLength = bitMask.length();
-    if (significantBitsInLastByte != 0)
+    std::size_t bitMaskLength = static_cast< std::size_t >(end - begin) * 8;
+    if (significantBitsInLastByte != 0 && bitMaskLength != 0)
     {
       bitMaskLength = bitMaskLength - 8 + significantBitsInLastByte;
     }
 
-    std::string buffer;
+    std::vector< DecodeNode > trie = buildDecodeTrie(symbols_);
     std::string destination;
+    int node = 0;
     for (std::size_t i = 0; i < bitMaskLength; ++i)
     {
-      buffer += bitMask[i];
-
-      auto it = codeMap_.find(buffer);
-      if (it != codeMap_.end())
+      unsigned char byte = static_cast< unsigned char >(begin[i / 8]);
+      node = trie[node].child[(byte >> (7 - i % 8)) & 1];
+      if (node == -1)
+      {
+        break;
+      }
+      if (trie[node].symbol != -1)
       {
-        destination += it->second.symbol;
-        buffer.clear();
+        destination += static_cast< char >(trie[node].symbol);
+        node = 0;
       }
     }
     return destination;
   }
 
-  double ShannonFanoTable::calculateEntropy()
-  {
-    auto accumulator = logFrequencyAccumulator;
-    return -1 * std::accumulate(symbols_.begin(), symbols_.end(), 0.0, accumulator);
-  }
-
   std::ostream& operator<<(std::ostream& out, const ShannonFanoTable& table)
   {
     iofmtguard ofmtguard(out);
@@ -15,9 +15,11 @@ namespace voronina
   {
   public:
     void generateShannonFanoCodes(const std::string& text, const std::string originFile = "");
+    void generateShannonFanoCodes(const char* begin, const char* end, const std::string originFile = "");
     int encode(const std::string& text, std::string& destination) const;
+    int encode(const char* begin, const char* end, std::vector< unsigned char >& destination) const;
     std::string decode(const std::string& text, int amountOfSignificantBitsInLastByte) const;
-    double calculateEntropy();
+    std::string decode(const char* begin, const char* end, int amountOfSignificantBitsInLastByte) const;
     const std::vector< Symbol >& symbols() const;
     int size() const;
     const std::string& originFile() const;
@@ -30,9 +32,8 @@ namespace voronina
     std::string originFile_;
     std::vector< Symbol > symbols_;
     std::unordered_map< char, Symbol > symbolMap_;
-    std::unordered_map< std::string, Symbol > codeMap_;
 
-    void initializeSymbolFrequencies(const std::string& text);
+    void initializeSymbolFrequencies(const char* begin, const char* end);
     void shannonFanoRecursion(const SymbIter& begin, const SymbIter& end);
   };
 }
@@ -0,0 +1,92 @@
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Histogram.h"
+
+// Counting throughput of countSymbols against a plain memory copy of the same buffer and the former
+// unordered_map count. Run with `make test-voronina.nadia/F0 TEST_ARGS="--log_level=message -- <megabytes>"`
+// (64 MB by default).
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  std::size_t benchmarkMegabytes()
+  {
+    const auto& suite = boost::unit_test::framework::master_test_suite();
+    return suite.argc > 1 ? std::stoul(suite.argv[1]) : 64;
+  }
+
+  std::vector< char > randomText(std::size_t size)
+  {
+    std::mt19937 generator(3);
+    std::vector< char > text(size);
+    for (char& c : text)
+    {
+      c = static_cast< char >(generator());
+    }
+    return text;
+  }
+
+  double megabytesPerSecond(std::size_t bytes, Clock::duration elapsed)
+  {
+    return bytes / 1e6 / std::max(std::chrono::duration< double >(elapsed).count(), 1e-9);
+  }
+
+  voronina::Histogram referenceCount(const std::vector< char >& text)
+  {
+    voronina::Histogram histogram{};
+    for (char c : text)
+    {
+      ++histogram[static_cast< unsigned char >(c)];
+    }
+    return histogram;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(count_symbols_matches_reference)
+{
+  std::vector< char > text = randomText(100003);
+  text.insert(text.end(), 5000, 'a');
+  BOOST_CHECK(voronina::countSymbols(text.data(), text.data() + text.size()) == referenceCount(text));
+  BOOST_CHECK_EQUAL(voronina::totalCount(voronina::countSymbols(text.data(), text.data())), 0);
+}
+
+BOOST_AUTO_TEST_CASE(count_symbols_throughput)
+{
+  std::vector< char > text = randomText(benchmarkMegabytes() << 20);
+  std::vector< char > copy(text.size());
+
+  auto start = Clock::now();
+  std::memcpy(copy.data(), text.data(), text.size());
+  auto copyTime = Clock::now() - start;
+
+  start = Clock::now();
+  voronina::Histogram histogram = voronina::countSymbols(text.data(), text.data() + text.size());
+  auto histogramTime = Clock::now() - start;
+
+  start = Clock::now();
+  std::unordered_map< char, std::size_t > counts;
+  for (char c : text)
+  {
+    ++counts[c];
+  }
+  auto mapTime = Clock::now() - start;
+
+  std::string runs(text.size(), 'a');
+  start = Clock::now();
+  voronina::Histogram runHistogram = voronina::countSymbols(runs.data(), runs.data() + runs.size());
+  auto runTime = Clock::now() - start;
+
+  BOOST_CHECK_EQUAL(voronina::totalCount(histogram), text.size());
+  BOOST_CHECK_EQUAL(counts['a'], histogram[static_cast< unsigned char >('a')]);
+  BOOST_CHECK_EQUAL(runHistogram[static_cast< unsigned char >('a')], runs.size());
+  BOOST_CHECK(copy == text);
+  BOOST_TEST_MESSAGE(text.size() << " bytes: memcpy " << megabytesPerSecond(text.size(), copyTime) << " MB/s, "
+      << "countSymbols " << megabytesPerSecond(text.size(), histogramTime) << " MB/s ("
+      << megabytesPerSecond(runs.size(), runTime) << " MB/s on one repeated byte), "
+      << "unordered_map " << megabytesPerSecond(text.size(), mapTime) << " MB/s");
+}